@@ -0,0 +1,207 @@
+# delta_ota.py
+#
+# Genereaza si aplica patch-uri delta pentru update OTA (format EDLT v1).
+#
+#   python delta_ota.py diff  old.bin new.bin patch.bin
+#   python delta_ota.py apply old.bin patch.bin out.bin
+#   python delta_ota.py check old.bin new.bin      (diff + apply + compare)
+#
+# Patch layout (little endian):
+#   header (80 bytes, uncompressed)
+#     "EDLT" | version u8 | flags u8 | reserved u16
+#     old_size u32 | new_size u32
+#     sha256(old image) [32] | sha256(new image) [32]
+#   zlib stream of records, bsdiff style:
+#     diff_len u32 | extra_len u32 | seek i32
+#     diff_len bytes  -> new[i] = old[pos + i] + diff[i]  (mod 256)
+#     extra_len bytes -> copied as-is
+#     old pos += diff_len + seek
+#
+# The device (src/ota_delta.cpp) inflates the stream and applies the
+# records on the fly against the running OTA partition.
+
+import hashlib
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = b"EDLT"
+VERSION = 1
+HEADER = struct.Struct("<4sBBHII32s32s")
+CTRL = struct.Struct("<IIi")
+
+SEED = 8          # Exact bytes needed to start a match
+STRIDE = 4        # Old image is indexed every STRIDE bytes
+GIVE_UP = 256     # Stop extending after this many bytes without gain
+
+
+def build_index(old):
+    index = {}
+    for i in range(0, len(old) - SEED + 1, STRIDE):
+        index.setdefault(old[i:i + SEED], i)
+    return index
+
+
+def extend_forward(old, new, o, n):
+    """Approximate match length from (o, n): keep going while >50% match."""
+    limit = min(len(old) - o, len(new) - n)
+    score = best_score = 0
+    best = 0
+    i = 0
+    while i < limit:
+        score += 1 if old[o + i] == new[n + i] else -1
+        i += 1
+        if score > best_score:
+            best_score, best = score, i
+        elif i - best > GIVE_UP:
+            break
+    return best
+
+
+def extend_backward(old, new, o, n, floor):
+    """Approximate match length going left from (o, n), not below `floor` in new."""
+    limit = min(o, n - floor)
+    score = best_score = 0
+    best = 0
+    i = 0
+    while i < limit:
+        i += 1
+        score += 1 if old[o - i] == new[n - i] else -1
+        if score > best_score:
+            best_score, best = score, i
+        elif i - best > GIVE_UP:
+            break
+    return best
+
+
+def find_matches(old, new):
+    """List of (new_start, old_start, length) approximate matches, in order."""
+    index = build_index(old)
+    matches = []
+    pos = 0
+    covered = 0       # new bytes before this are already in a match
+    delta = None      # old - new offset of the previous match
+
+    while pos <= len(new) - SEED:
+        seed = None
+        # Prefer continuing the previous alignment, then the index
+        if delta is not None and 0 <= pos + delta <= len(old) - SEED and \
+                old[pos + delta:pos + delta + SEED] == new[pos:pos + SEED]:
+            seed = pos + delta
+        else:
+            seed = index.get(new[pos:pos + SEED])
+            if seed is not None and old[seed:seed + SEED] != new[pos:pos + SEED]:
+                seed = None
+
+        if seed is None:
+            pos += 1
+            continue
+
+        back = extend_backward(old, new, seed, pos, covered)
+        fwd = extend_forward(old, new, seed, pos)
+        start_new, start_old = pos - back, seed - back
+        length = back + fwd
+
+        matches.append((start_new, start_old, length))
+        covered = start_new + length
+        delta = start_old - start_new
+        pos = covered
+
+    return matches
+
+
+def diff(old, new):
+    matches = find_matches(old, new)
+    out = bytearray()
+
+    old_pos = 0
+    new_pos = 0
+
+    # Leading record: literal bytes before the first match + seek to it
+    first_new = matches[0][0] if matches else len(new)
+    first_old = matches[0][1] if matches else 0
+    out += CTRL.pack(0, first_new, first_old)
+    out += new[:first_new]
+    old_pos, new_pos = first_old, first_new
+
+    for k, (n, o, length) in enumerate(matches):
+        assert n == new_pos and o == old_pos
+        nxt_new, nxt_old = (matches[k + 1][0], matches[k + 1][1]) if k + 1 < len(matches) else (len(new), o + length)
+        extra = nxt_new - (n + length)
+        seek = nxt_old - (o + length)
+        out += CTRL.pack(length, extra, seek)
+        out += bytes((new[n + i] - old[o + i]) & 0xFF for i in range(length))
+        out += new[n + length:nxt_new]
+        old_pos, new_pos = nxt_old, nxt_new
+
+    header = HEADER.pack(MAGIC, VERSION, 0, 0, len(old), len(new),
+                         hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return header + zlib.compress(bytes(out), 9)
+
+
+def apply(old, patch):
+    magic, version, _, _, old_size, new_size, old_sha, new_sha = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not an EDLT v1 patch")
+    if old_size != len(old) or hashlib.sha256(old).digest() != old_sha:
+        raise ValueError("patch was made for a different source image")
+
+    body = zlib.decompress(patch[HEADER.size:])
+    new = bytearray()
+    pos = 0
+    i = 0
+    while len(new) < new_size:
+        diff_len, extra_len, seek = CTRL.unpack_from(body, i)
+        i += CTRL.size
+        for k in range(diff_len):
+            src = old[pos + k] if 0 <= pos + k < len(old) else 0
+            new.append((src + body[i + k]) & 0xFF)
+        i += diff_len
+        new += body[i:i + extra_len]
+        i += extra_len
+        pos += diff_len + seek
+
+    if hashlib.sha256(new).digest() != new_sha:
+        raise ValueError("result does not match the new image digest")
+    return bytes(new)
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def main(argv):
+    if len(argv) == 5 and argv[1] == "diff":
+        old, new = read(argv[2]), read(argv[3])
+        t = time.time()
+        patch = diff(old, new)
+        with open(argv[4], "wb") as f:
+            f.write(patch)
+        print(f"📦 Patch: {len(patch)} bytes ({100.0 * len(patch) / len(new):.1f}% of {len(new)}) in {time.time() - t:.1f}s")
+        return 0
+
+    if len(argv) == 5 and argv[1] == "apply":
+        new = apply(read(argv[2]), read(argv[3]))
+        with open(argv[4], "wb") as f:
+            f.write(new)
+        print(f"✅ Applied: {len(new)} bytes")
+        return 0
+
+    if len(argv) == 4 and argv[1] == "check":
+        old, new = read(argv[2]), read(argv[3])
+        patch = diff(old, new)
+        ok = apply(old, patch) == new
+        print(f"{'✅' if ok else '❌'} Round trip {'OK' if ok else 'MISMATCH'}: "
+              f"old={len(old)} new={len(new)} patch={len(patch)} ({100.0 * len(patch) / len(new):.1f}%)")
+        return 0 if ok else 1
+
+    print("usage:\n  delta_ota.py diff old.bin new.bin patch.bin\n"
+          "  delta_ota.py apply old.bin patch.bin out.bin\n"
+          "  delta_ota.py check old.bin new.bin")
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
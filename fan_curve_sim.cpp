@@ -0,0 +1,120 @@
+// fan_curve_sim.cpp
+//
+// Simulare pe host pentru include/fan_curve.h: evaluarea curbei
+// (cautare binara + interpolare), histerezisul pe temperatura si
+// timpii minimi de pornire/oprire.
+// Compilare, rulare si verificari: host_check.h.
+//
+// Scenarii (control la 1 s, ca fan_control_interval implicit):
+//   1. puncte date in dezordine, cu duplicate -> sortate, valori
+//      interpolate corect, capetele se pastreaza
+//   2. 40 C +/- 0.8 C zgomot timp de 10 min: fara histerezis iesirea
+//      schimba des directia, cu 2 C la coborare aproape deloc
+//   3. temperatura trece prin pragul de pornire (39..41 C, perioada
+//      4 s): cu min_on 10 s / min_off 5 s ventilatorul porneste de
+//      cel mult o data la 15 s
+//   4. cost per evaluare pe o curba de 16 puncte
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <initializer_list>
+#include "fan_curve.h"
+#include "host_check.h"
+
+static FanCurve makeCurve(std::initializer_list<FanCurvePoint> pts)
+{
+  FanCurve c;
+  for (const FanCurvePoint &p : pts)
+    c.pts[c.count++] = p;
+  c.normalize();
+  return c;
+}
+
+// Deterministic noise in [-1, 1]
+static float noise(uint32_t &seed)
+{
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+}
+
+// Direction changes of the output bigger than 0.5%
+static int reversals(CurveFollower f, const FanCurve &c)
+{
+  uint32_t seed = 7;
+  float prev = NAN;
+  int dir = 0, flips = 0;
+  for (uint32_t t = 0; t < 600; t++)
+  {
+    float temp = 40.0f + 0.8f * noise(seed);
+    float pct = f.dwell(c.eval(f.track(temp)), t * 1000);
+    if (!isnan(prev) && fabsf(pct - prev) > 0.5f)
+    {
+      int d = pct > prev ? 1 : -1;
+      if (dir && d != dir)
+        flips++;
+      dir = d;
+    }
+    prev = pct;
+  }
+  return flips;
+}
+
+int main(int argc, char **argv)
+{
+  hostCheckBegin(argc, argv);
+
+  FanCurve c = makeCurve({{60, 100}, {30, 0}, {40, 30}, {40, 35}, {50, 70}});
+  check(c.count == 4 && c.pts[0].tempC == 30 && c.pts[1].percent == 35 && c.pts[3].tempC == 60,
+        "normalize sorts and keeps the last duplicate");
+  check(c.eval(20) == 0 && c.eval(30) == 0 && fabsf(c.eval(35) - 17.5f) < 1e-4f &&
+            fabsf(c.eval(45) - 52.5f) < 1e-4f && c.eval(55) == 85 && c.eval(80) == 100,
+        "eval interpolates and holds the end values");
+
+  FanCurve ramp = makeCurve({{30, 0}, {50, 100}});
+  CurveFollower plain;
+  CurveFollower hyst;
+  hyst.hystFall = 2;
+  int a = reversals(plain, ramp), b = reversals(hyst, ramp);
+  printf("     40 C +/- 0.8 C, 10 min: %d reversals without hysteresis, %d with 2 C\n", a, b);
+  check(a > 50 && b <= 2, "falling hysteresis stops the hunting");
+
+  // Threshold crossings: curve off below 40 C
+  FanCurve gate = makeCurve({{40, 0}, {41, 40}, {60, 100}});
+  CurveFollower dw;
+  dw.minOnMs = 10000;
+  dw.minOffMs = 5000;
+  int starts = 0;
+  bool on = false;
+  for (uint32_t t = 0; t < 120; t++)
+  {
+    float temp = 40.0f + sinf(t * 2 * (float)M_PI / 4) * 1.0f;
+    float pct = dw.dwell(gate.eval(dw.track(temp)), t * 1000);
+    if (pct > 0 && !on)
+      starts++;
+    on = pct > 0;
+    if (trace)
+      printf("  t=%3us temp=%5.2f pct=%5.1f\n", (unsigned)t, temp, pct);
+  }
+  printf("     39..41 C every 4 s, 120 s: %d starts\n", starts);
+  check(starts >= 1 && starts <= 120 / 15 + 1, "min on/off dwell limits restarts");
+
+  CurveFollower nanF;
+  check(isnan(nanF.track(NAN)) && nanF.track(45) == 45 && nanF.track(NAN) == 45,
+        "NaN reading keeps the last tracked temperature");
+
+  FanCurve big;
+  for (int i = 0; i < FAN_CURVE_POINTS; i++)
+    big.pts[big.count++] = {(int16_t)(20 + i * 5), (uint8_t)(i * 100 / (FAN_CURVE_POINTS - 1))};
+  big.normalize();
+  volatile float sink = 0;
+  const int N = 10000000;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < N; i++)
+    sink = sink + big.eval(15.0f + (i % 1000) * 0.1f);
+  auto t1 = std::chrono::steady_clock::now();
+  printf("     eval on %d points: %.1f ns (host)\n", FAN_CURVE_POINTS,
+         std::chrono::duration<double, std::nano>(t1 - t0).count() / N);
+
+  return hostCheckDone();
+}
@@ -0,0 +1,141 @@
+// fan_tach_sim.cpp
+//
+// Simulare pe host pentru include/fan_tach.h: SimFan genereaza
+// impulsuri de tahometru din duty, TachMeter calculeaza RPM-ul si
+// detecteaza blocarea, RpmController tine turatia in bucla inchisa.
+// Compilare, rulare si verificari: host_check.h.
+//
+// Scenarii (pas de 20 ms ca taskControl, control la 200 ms):
+//   1. duty 10% pornind din repaus fara boost -> ventilatorul nu
+//      porneste, blocarea trebuie detectata
+//   2. acelasi duty cu boost de 300 ms la 60% -> porneste, dar sub
+//      pragul minim se opreste din nou -> blocare
+//   3. bucla inchisa la 1500 RPM pe un ventilator care face doar
+//      2600 RPM la 100% (feed-forward presupune 3000) -> eroare < 3%
+//   4. treapta 1500 -> 2200 RPM -> eroare < 3% dupa 5 s
+//   5. fereastra de 3 s (mai lunga decat 64 de citiri la 20 ms):
+//      treapta 1500 -> 3000 RPM pe impulsuri sintetice -> la 1,5 s
+//      media ferestrei e la jumatate, la 3,2 s ajunge la 3000
+
+#include <cstdio>
+#include <cmath>
+#include "fan_tach.h"
+#include "host_check.h"
+
+static const uint32_t TICK_MS = 20;
+static const uint32_t CONTROL_MS = 200;
+
+struct Rig
+{
+  SimFan fan;
+  TachMeter tach;
+  RpmController loop;
+  uint32_t now = 0;
+  float duty = 0;
+  uint32_t boostUntil = 0;
+
+  Rig()
+  {
+    tach.configure(2, 1000, 2000);
+  }
+
+  // Open loop; `boostPct` = 0 disables the kick
+  void runDuty(float pct, float boostPct, uint32_t boostMs, uint32_t ms)
+  {
+    if (duty == 0 && pct > 0 && boostPct > 0)
+    {
+      duty = boostPct;
+      boostUntil = now + boostMs;
+    }
+    for (uint32_t end = now + ms; now < end; now += TICK_MS)
+    {
+      if (boostUntil && now >= boostUntil)
+      {
+        duty = pct;
+        boostUntil = 0;
+      }
+      else if (!boostUntil)
+        duty = pct;
+      tick();
+    }
+  }
+
+  void runRpm(float target, uint32_t ms)
+  {
+    for (uint32_t end = now + ms; now < end; now += TICK_MS)
+    {
+      if (now % CONTROL_MS == 0)
+        duty = loop.update(target, tach.rpm(), CONTROL_MS / 1000.0f);
+      tick();
+    }
+  }
+
+  void tick()
+  {
+    fan.step(duty, TICK_MS / 1000.0f);
+    tach.sample(now, fan.pulses(), duty > 0 && !boostUntil);
+    if (trace && now % 500 == 0)
+      printf("  t=%5u ms duty=%5.1f%% fan=%6.0f rpm tach=%6.0f rpm%s\n",
+             (unsigned)now, duty, fan.rpm(), tach.rpm(), tach.stalled() ? " STALL" : "");
+  }
+};
+
+int main(int argc, char **argv)
+{
+  hostCheckBegin(argc, argv);
+
+  {
+    Rig r;
+    r.runDuty(10, 0, 0, 4000);
+    check(r.fan.rpm() == 0 && r.tach.stalled() && r.tach.stalls() == 1,
+          "10% from rest without boost: no breakaway, stall flagged");
+  }
+  {
+    Rig r;
+    r.runDuty(10, 60, 300, 6000);
+    check(r.tach.stalled(), "10% after a 60% boost: below the minimum duty, stall flagged");
+  }
+  {
+    Rig r;
+    r.runDuty(25, 60, 300, 4000);
+    check(!r.tach.stalled() && fabsf(r.tach.rpm() - 750) < 40, "25% after boost: runs near 750 rpm, no stall");
+  }
+
+  Rig r;
+  r.fan.maxRpm = 2600;   // Slower than the feed-forward assumes
+  r.runRpm(1500, 8000);
+  float err = fabsf(r.tach.rpm() - 1500) / 1500;
+  printf("     closed loop 1500: tach=%.0f rpm duty=%.1f%% integral=%.1f\n", r.tach.rpm(), r.duty, r.loop.integral());
+  check(err < 0.03f, "closed loop holds 1500 rpm within 3%");
+
+  r.runRpm(2200, 5000);
+  err = fabsf(r.tach.rpm() - 2200) / 2200;
+  printf("     closed loop 2200: tach=%.0f rpm duty=%.1f%%\n", r.tach.rpm(), r.duty);
+  check(err < 0.03f, "step to 2200 rpm settles within 3% in 5 s");
+
+  r.runRpm(0, 3000);
+  check(r.duty == 0 && r.loop.integral() == 0, "target 0 stops the fan and clears the integral");
+
+  {
+    TachMeter t;
+    t.configure(2, 3000, 2000);
+    uint32_t ms = 0;
+    double pulses = 0;
+    auto feed = [&](float rpm, uint32_t dur)
+    {
+      for (uint32_t end = ms + dur; ms < end; ms += TICK_MS)
+      {
+        pulses += rpm * 2 / 60.0 * TICK_MS / 1000.0;
+        t.sample(ms, (uint32_t)pulses, true);
+      }
+    };
+    feed(1500, 10000);
+    feed(3000, 1500);
+    float mid = t.rpm();
+    feed(3000, 1700);
+    printf("     3 s window: %.0f rpm after 1.5 s, %.0f rpm after 3.2 s\n", mid, t.rpm());
+    check(fabsf(mid - 2250) < 60 && fabsf(t.rpm() - 3000) < 30, "3 s window averages over the whole window");
+  }
+
+  return hostCheckDone();
+}
@@ -0,0 +1,37 @@
+// host_check.h
+//
+// Cadrul comun al simularilor pe host (*_sim.cpp din radacina).
+// Simularile folosesc doar headerele din include/ care nu depind
+// de Arduino:
+//
+//   g++ -O2 -std=gnu++17 -I include <nume>_sim.cpp -o <nume>_sim
+//   ./<nume>_sim [trace]
+//
+// check() afiseaza PASS/FAIL pentru fiecare verificare; hostCheckDone()
+// afiseaza OK/FAILED si intoarce codul de iesire (1 la orice esec).
+// Cu argumentul "trace" simularile afiseaza si traiectoria.
+
+#pragma once
+#include <cstdio>
+#include <cstring>
+
+static bool trace = false;
+static int failures = 0;
+
+static void hostCheckBegin(int argc, char **argv)
+{
+  trace = argc > 1 && !strcmp(argv[1], "trace");
+}
+
+static void check(bool ok, const char *what)
+{
+  printf("%s %s\n", ok ? "PASS" : "FAIL", what);
+  if (!ok)
+    failures++;
+}
+
+static int hostCheckDone()
+{
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================
+// 📈 Fan curves with hysteresis and dwell
+// ------------------------------------------------------------
+// FanCurve is a piecewise-linear temperature -> percent table
+// of up to FAN_CURVE_POINTS points, kept sorted by temperature
+// (normalize()). eval() binary-searches the segment and
+// interpolates; below the first / above the last point the end
+// value holds. Nothing is allocated.
+//
+// CurveFollower keeps the output from hunting:
+// - track(): the curve is read at a temperature that trails the
+//   sensor by hystRise on the way up and hystFall on the way
+//   down (a backlash band), so a wobble inside the band does
+//   not move the fan;
+// - dwell(): once started the fan stays on for minOnMs, once
+//   stopped it stays off for minOffMs.
+//
+// No Arduino/FreeRTOS dependency: the same code runs on the
+// device (fan_zones.cpp) and in the host simulation
+// (fan_curve_sim.cpp).
+// ============================================================
+#ifndef FAN_CURVE_POINTS
+#define FAN_CURVE_POINTS 16
+#endif
+
+struct FanCurvePoint
+{
+  int16_t tempC;
+  uint8_t percent;
+};
+
+struct FanCurve
+{
+  uint8_t count = 0;   // < 2 = no curve
+  FanCurvePoint pts[FAN_CURVE_POINTS] = {};
+
+  bool valid() const { return count >= 2; }
+
+  // Sorts by temperature (insertion, stable), keeps the last of
+  // equal temperatures and caps percent at 100
+  void normalize()
+  {
+    if (count > FAN_CURVE_POINTS)
+      count = FAN_CURVE_POINTS;
+    for (uint8_t i = 1; i < count; i++)
+    {
+      FanCurvePoint p = pts[i];
+      uint8_t j = i;
+      for (; j > 0 && pts[j - 1].tempC > p.tempC; j--)
+        pts[j] = pts[j - 1];
+      pts[j] = p;
+    }
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (pts[i].percent > 100)
+        pts[i].percent = 100;
+      if (n && pts[n - 1].tempC == pts[i].tempC)
+        pts[n - 1] = pts[i];
+      else
+        pts[n++] = pts[i];
+    }
+    count = n;
+  }
+
+  float eval(float t) const
+  {
+    if (!count)
+      return 0;
+    if (!(t > pts[0].tempC))
+      return pts[0].percent;
+    if (t >= pts[count - 1].tempC)
+      return pts[count - 1].percent;
+
+    // pts[lo].tempC <= t < pts[hi].tempC
+    uint8_t lo = 0, hi = count - 1;
+    while (hi - lo > 1)
+    {
+      uint8_t mid = (lo + hi) / 2;
+      if (pts[mid].tempC <= t)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    const FanCurvePoint &a = pts[lo];
+    const FanCurvePoint &b = pts[hi];
+    return a.percent + (float)(b.percent - a.percent) * (t - a.tempC) / (float)(b.tempC - a.tempC);
+  }
+};
+
+class CurveFollower
+{
+public:
+  float hystRise = 0;      // °C the reading must climb past the band
+  float hystFall = 0;      // °C it must drop below the band
+  uint32_t minOnMs = 0;
+  uint32_t minOffMs = 0;
+
+  void reset()
+  {
+    tracking_ = false;
+    switched_ = false;
+  }
+
+  // Temperature to read the curve at; NaN until a first reading
+  float track(float t)
+  {
+    if (isnan(t))
+      return tracking_ ? tEff_ : NAN;
+    if (!tracking_)
+    {
+      tEff_ = t;
+      tracking_ = true;
+    }
+    else if (t > tEff_ + hystRise)
+      tEff_ = t - hystRise;
+    else if (t < tEff_ - hystFall)
+      tEff_ = t + hystFall;
+    return tEff_;
+  }
+
+  // Output after the on/off dwell: holds the last running percent
+  // (or 0) until the dwell of the current state has passed
+  float dwell(float pct, uint32_t nowMs)
+  {
+    bool want = pct > 0;
+    if (switched_ && want != on_)
+    {
+      uint32_t hold = on_ ? minOnMs : minOffMs;
+      if (nowMs - sinceMs_ < hold)
+        return on_ ? last_ : 0;
+    }
+    if (!switched_ || want != on_)
+    {
+      on_ = want;
+      sinceMs_ = nowMs;
+      switched_ = true;
+    }
+    if (want)
+      last_ = pct;
+    return pct;
+  }
+
+  float tracked() const { return tracking_ ? tEff_ : NAN; }
+
+private:
+  bool tracking_ = false;
+  float tEff_ = 0;
+  bool switched_ = false;   // First dwell() seen
+  bool on_ = false;
+  uint32_t sinceMs_ = 0;
+  float last_ = 0;
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================
+// 🧭 Fan tachometer, RPM loop and simulated fan
+// ------------------------------------------------------------
+// TachMeter turns a cumulative pulse count, read periodically
+// (PCNT on the device, SimFan on the host), into RPM over a
+// sliding window and flags a stall when a driven fan stops
+// producing pulses. The ring keeps one sample per window /
+// (TACH_SAMPLES - 2) ms, so any window fits in it whatever the
+// read period; the RPM is taken from the latest reading.
+//
+// RpmController is a PI loop with feed-forward: it returns the
+// duty (%) that holds a target RPM.
+//
+// SimFan is the HAL stand-in: a first-order fan model that
+// breaks away above a start duty, stops below a minimum duty
+// and emits tach pulses for the RPM it reaches.
+//
+// No Arduino/FreeRTOS dependency: the same code runs on the
+// device (fan_tach.cpp) and in the host simulation
+// (fan_tach_sim.cpp).
+// ============================================================
+#ifndef TACH_SAMPLES
+#define TACH_SAMPLES 64   // Ring of (ms, count) spread over the window
+#endif
+
+class TachMeter
+{
+public:
+  void configure(uint8_t pulsesPerRev, uint16_t windowMs, uint16_t stallMs)
+  {
+    ppr_ = pulsesPerRev ? pulsesPerRev : 2;
+    windowMs_ = windowMs ? windowMs : 1000;
+    stallMs_ = stallMs ? stallMs : 2000;
+    spacingMs_ = windowMs_ / (TACH_SAMPLES - 2);
+  }
+
+  // `pulses` is cumulative (wraps at 2^32); `driven` = duty > 0
+  void sample(uint32_t nowMs, uint32_t pulses, bool driven)
+  {
+    if (count_ == 0 || pulses != latest_.pulses)
+      lastPulseMs_ = nowMs;
+
+    latest_ = {nowMs, pulses};
+    if (count_ == 0 || nowMs - ring_[head_].ms >= spacingMs_)
+    {
+      head_ = (head_ + 1) % TACH_SAMPLES;
+      ring_[head_] = latest_;
+      if (count_ < TACH_SAMPLES)
+        count_++;
+    }
+
+    if (!driven)
+      drivenSinceMs_ = 0;
+    else if (!drivenSinceMs_)
+      drivenSinceMs_ = nowMs | 1;
+
+    // Stalled: driven for stallMs with no pulse in that time
+    bool was = stalled_;
+    uint32_t since = lastPulseMs_;
+    if (drivenSinceMs_ && (int32_t)(drivenSinceMs_ - since) > 0)
+      since = drivenSinceMs_;
+    stalled_ = drivenSinceMs_ && (int32_t)(nowMs - since) >= (int32_t)stallMs_;
+    if (stalled_ && !was)
+      stalls_++;
+
+    rpm_ = computeRpm(nowMs);
+  }
+
+  float rpm() const { return rpm_; }
+  bool stalled() const { return stalled_; }
+  uint32_t stalls() const { return stalls_; }
+  uint32_t pulses() const { return latest_.pulses; }
+
+private:
+  struct Sample
+  {
+    uint32_t ms;
+    uint32_t pulses;
+  };
+
+  // Pulses since the oldest sample still inside the window (at
+  // least the one before the latest reading)
+  float computeRpm(uint32_t nowMs) const
+  {
+    if (count_ < 2)
+      return 0;
+    const Sample &newest = latest_;
+    const Sample *oldest = nullptr;
+    for (uint16_t k = 0; k < count_; k++)
+    {
+      const Sample &s = ring_[(head_ + TACH_SAMPLES - k) % TACH_SAMPLES];
+      if (oldest && oldest->ms != newest.ms && nowMs - s.ms > windowMs_)
+        break;
+      oldest = &s;
+    }
+    uint32_t dt = newest.ms - oldest->ms;
+    if (!dt)
+      return 0;
+    return (float)(newest.pulses - oldest->pulses) * 60000.0f / ((float)ppr_ * dt);
+  }
+
+  Sample ring_[TACH_SAMPLES] = {};
+  Sample latest_ = {};
+  uint16_t head_ = 0;
+  uint16_t count_ = 0;
+  uint8_t ppr_ = 2;
+  uint16_t windowMs_ = 1000;
+  uint16_t spacingMs_ = 1000 / (TACH_SAMPLES - 2);
+  uint16_t stallMs_ = 2000;
+  uint32_t lastPulseMs_ = 0;
+  uint32_t drivenSinceMs_ = 0;   // 0 = not driven
+  bool stalled_ = false;
+  uint32_t stalls_ = 0;
+  float rpm_ = 0;
+};
+
+class RpmController
+{
+public:
+  float kp = 0.02f;      // % duty per RPM of error
+  float ki = 0.05f;      // % duty per RPM·s
+  float maxRpm = 3000;   // RPM at 100% (feed-forward)
+
+  void reset() { integ_ = 0; }
+
+  // Duty (%) for `targetRpm`; the integral stops at the output limits
+  float update(float targetRpm, float measuredRpm, float dtS)
+  {
+    if (targetRpm <= 0)
+    {
+      integ_ = 0;
+      return 0;
+    }
+    float ff = maxRpm > 0 ? targetRpm * 100.0f / maxRpm : 0;
+    float err = targetRpm - measuredRpm;
+    float out = ff + kp * err + integ_;
+    bool pushing = (out >= 100 && err > 0) || (out <= 0 && err < 0);
+    if (!pushing)
+      integ_ += ki * err * dtS;
+    out = ff + kp * err + integ_;
+    return out < 0 ? 0 : out > 100 ? 100 : out;
+  }
+
+  float integral() const { return integ_; }
+
+private:
+  float integ_ = 0;
+};
+
+class SimFan
+{
+public:
+  float maxRpm = 3000;
+  float tauS = 1.2f;          // Spin-up / spin-down time constant
+  float startPct = 30;        // Duty needed to break away from rest
+  float minPct = 15;          // A running fan stops below this
+  uint8_t pulsesPerRev = 2;
+
+  void step(float dutyPct, float dtS)
+  {
+    bool running = rpm_ > maxRpm * 0.02f;
+    float target = 0;
+    if (dutyPct >= (running ? minPct : startPct))
+      target = dutyPct * maxRpm / 100.0f;
+
+    rpm_ += (target - rpm_) * (1.0f - expf(-dtS / tauS));
+    if (target == 0 && rpm_ < 1)
+      rpm_ = 0;
+
+    frac_ += rpm_ * pulsesPerRev / 60.0f * dtS;
+    uint32_t whole = (uint32_t)frac_;
+    pulses_ += whole;
+    frac_ -= whole;
+  }
+
+  float rpm() const { return rpm_; }
+  uint32_t pulses() const { return pulses_; }
+
+private:
+  float rpm_ = 0;
+  float frac_ = 0;
+  uint32_t pulses_ = 0;
+};
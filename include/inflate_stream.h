@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+// ============================================================
+// 🗜️ InflateStream - streaming zlib/deflate decoder
+// ------------------------------------------------------------
+// Thin wrapper around the tinfl decoder in the ESP32 ROM.
+// Compressed bytes are fed as they arrive; decompressed output
+// is handed to a sink in pieces, so memory use is fixed:
+// one decoder state (~11 KB) + the 32 KB deflate window,
+// allocated in begin() and released in end().
+// GZIP headers are parsed here (tinfl only knows zlib/raw) and
+// the trailer CRC-32 and length are checked.
+// ============================================================
+typedef bool (*InflateSink)(const uint8_t *data, size_t len, void *ctx);
+
+class InflateStream
+{
+public:
+  enum Format : uint8_t
+  {
+    ZLIB,   // RFC 1950 header + adler32 trailer (Python zlib.compress)
+    RAW,    // Bare deflate blocks
+    GZIP    // RFC 1952 header + crc32/size trailer (gzip, pigz)
+  };
+
+  ~InflateStream() { end(); }
+
+  bool begin(Format format);
+  // Returns false on corrupt input or when the sink refuses data
+  bool feed(const uint8_t *data, size_t len, InflateSink sink, void *ctx);
+  void end();
+
+  bool done() const { return done_; }
+  size_t produced() const { return produced_; }
+  static size_t memoryUse();
+
+private:
+  enum class GzState : uint8_t
+  {
+    NONE,
+    HEADER,    // 10 fixed bytes
+    XLEN,      // FEXTRA length
+    EXTRA,
+    NAME,      // zero-terminated
+    COMMENT,   // zero-terminated
+    HCRC,
+    BODY,
+    TRAILER    // crc32 + isize
+  };
+
+  bool parseGzipHeader(const uint8_t *&data, size_t &len);
+  void enterGzState(GzState after);
+  bool checkGzipTrailer();
+
+  void *decomp_ = nullptr;
+  uint8_t *window_ = nullptr;
+  size_t outPos_ = 0;
+  size_t produced_ = 0;
+  uint32_t flags_ = 0;
+  bool done_ = false;
+
+  GzState gz_ = GzState::NONE;
+  uint8_t gzFlags_ = 0;
+  uint8_t gzBuf_[10];   // Fixed header, XLEN or trailer
+  size_t gzFill_ = 0;
+  size_t gzSkip_ = 0;
+  uint32_t crc_ = 0;
+};
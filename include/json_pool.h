@@ -0,0 +1,152 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ============================================================
+// 🧱 JSON memory pools
+// ------------------------------------------------------------
+// Every JsonDocument built by a handler or by the settings code
+// allocates from a static bump arena instead of the general heap.
+// A task claims one pool for the duration of a request and the
+// whole arena is dropped in one step when the outermost scope
+// ends, so long uptimes no longer chip away at the largest free
+// heap block.
+// ============================================================
+#ifndef JSON_POOL_COUNT
+#define JSON_POOL_COUNT 4       // async_tcp, loopTask, two for bodies still sending
+#endif
+#ifndef JSON_POOL_SIZE
+#define JSON_POOL_SIZE 8192     // Bytes per pool
+#endif
+
+// ============================================================
+// 🧮 JsonArena - bump allocator for ArduinoJson
+// ------------------------------------------------------------
+// - Blocks carry an 8-byte header with their size
+// - Only the most recent block can be freed / grown in place
+// - Requests that do not fit fall back to malloc() and are
+//   counted as overflows
+// ============================================================
+class JsonArena : public ArduinoJson::Allocator
+{
+public:
+  JsonArena(uint8_t *buf, size_t capacity) : buf_(buf), capacity_(capacity) {}
+
+  void *allocate(size_t size) override;
+  void deallocate(void *ptr) override;
+  void *reallocate(void *ptr, size_t new_size) override;
+
+  // Drop every block at once (end of request)
+  void reset()
+  {
+    used_ = 0;
+    last_ = NO_BLOCK;
+  }
+
+  bool owns(const void *p) const
+  {
+    return p >= buf_ && p < buf_ + capacity_;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t used() const { return used_; }
+  size_t highWater() const { return highWater_; }
+  uint32_t overflows() const { return overflows_; }
+
+private:
+  static constexpr size_t HEADER = 8;
+  static constexpr size_t NO_BLOCK = (size_t)-1;
+
+  static size_t align8(size_t n) { return (n + 7) & ~(size_t)7; }
+  uint32_t &blockSize(void *p) { return *(uint32_t *)((uint8_t *)p - HEADER); }
+  bool isLast(void *p) const { return (size_t)((uint8_t *)p - buf_) - HEADER == last_; }
+
+  uint8_t *buf_;
+  size_t capacity_;
+  size_t used_ = 0;
+  size_t last_ = NO_BLOCK;
+  size_t highWater_ = 0;
+  uint32_t overflows_ = 0;
+};
+
+// ============================================================
+// 🔒 JsonArenaScope - claim the calling task's pool
+// ------------------------------------------------------------
+// Nested scopes on the same task share the pool; it is reset
+// when the outermost one goes away. Declare it BEFORE the
+// documents that use it:
+//
+//   JsonArenaScope arena;
+//   JsonDocument doc(arena.allocator());
+// ============================================================
+class JsonArenaScope
+{
+public:
+  JsonArenaScope();
+  ~JsonArenaScope();
+  JsonArenaScope(const JsonArenaScope &) = delete;
+  JsonArenaScope &operator=(const JsonArenaScope &) = delete;
+
+  ArduinoJson::Allocator *allocator() { return arena_; }
+
+  // Keep the pool claimed past this scope (until jsonPoolRelease()),
+  // e.g. while a response still reads from it. The pool is detached
+  // from the task, so later scopes there claim another one.
+  // -1: no pool held.
+  int retain();
+
+private:
+  JsonArena *arena_;
+  int slot_;
+};
+
+void jsonPoolRelease(int slot);
+
+// ============================================================
+// ✍️ TextBuilder - fixed-capacity text in the calling task's pool
+// ------------------------------------------------------------
+//   JsonArenaScope arena;
+//   TextBuilder out(arena, 64);
+//   out.printf("{\"ok\":true,\"on\":%s}", on ? "true" : "false");
+//   sendText(req, 200, "application/json", out);
+//
+// The buffer is taken from the pool once; writes past the
+// capacity are dropped and reported by truncated(). sendText()
+// hands the buffer to the response, which keeps the pool until
+// the last byte is sent, so the body is never copied into a
+// String.
+// ============================================================
+class TextBuilder : public Print
+{
+public:
+  TextBuilder(JsonArenaScope &scope, size_t capacity);
+  ~TextBuilder();
+  TextBuilder(const TextBuilder &) = delete;
+  TextBuilder &operator=(const TextBuilder &) = delete;
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t n) override;
+  using Print::write;
+
+  // Formats in place (Print::printf would malloc past 64 bytes)
+  size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+  const char *c_str() const { return buf_ ? buf_ : ""; }
+  size_t length() const { return len_; }
+  size_t capacity() const { return cap_; }
+  bool truncated() const { return truncated_; }
+
+  // Give up the buffer (and a pool claim) to whoever frees it later
+  char *release(ArduinoJson::Allocator *&alloc, int &slot);
+
+private:
+  JsonArenaScope &scope_;
+  ArduinoJson::Allocator *alloc_;
+  char *buf_;
+  size_t cap_;
+  size_t len_ = 0;
+  bool truncated_ = false;
+};
+
+String jsonPoolReport();
+void fillJsonPoolStats(JsonArray out);
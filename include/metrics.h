@@ -0,0 +1,122 @@
+#pragma once
+#include <Arduino.h>
+
+// ============================================================
+// 📊 Metrics registry
+// ------------------------------------------------------------
+// Metrics are globals that link themselves into one list from
+// their constructors (static init), so nothing is allocated
+// after boot and nothing is registered at run time:
+//
+//   static MetricCounter canRx("can_frames", "CAN frames received", "dir=\"rx\"");
+//   canRx.inc();
+//
+// Counters and histograms keep one shard per core; an update is
+// a relaxed atomic add on the running core's shard, and readers
+// sum the shards. Gauges either hold the last set() value or
+// read their value at scrape time through a callback. A
+// collector emits a variable number of labelled samples (one
+// per task, per core...) at scrape time.
+//
+// /metrics renders every family in OpenMetrics text format,
+// streamed through a chunked response one line at a time.
+// Metrics sharing a name form one family; give each a distinct
+// label set.
+// ============================================================
+#ifndef METRICS_PREFIX
+#define METRICS_PREFIX "fanctl_"
+#endif
+#define METRIC_HIST_MAX_BOUNDS 12
+
+enum class MetricType : uint8_t
+{
+  COUNTER,
+  GAUGE,
+  HISTOGRAM
+};
+
+// Collector callback: fill the i-th sample's labels (without
+// braces, e.g. `task="Control"`) and value; false when done.
+typedef bool (*MetricCollectFn)(int i, char *labels, size_t n, float &value);
+
+class Metric
+{
+public:
+  const char *name;
+  const char *help;
+  const char *labels;   // `key="value",...` or nullptr
+  MetricType type;
+  MetricCollectFn collect = nullptr;
+  Metric *next;
+
+  static Metric *head();
+
+protected:
+  Metric(const char *name, const char *help, const char *labels, MetricType type);
+};
+
+class MetricCounter : public Metric
+{
+public:
+  MetricCounter(const char *name, const char *help, const char *labels = nullptr)
+      : Metric(name, help, labels, MetricType::COUNTER) {}
+  // Value kept elsewhere (e.g. a driver's cumulative counter)
+  MetricCounter(const char *name, const char *help, uint32_t (*read)(), const char *labels = nullptr)
+      : Metric(name, help, labels, MetricType::COUNTER), read_(read) {}
+
+  inline void inc(uint32_t n = 1)
+  {
+    __atomic_fetch_add(&shards_[xPortGetCoreID()], n, __ATOMIC_RELAXED);
+  }
+  uint32_t value() const;
+
+private:
+  uint32_t shards_[portNUM_PROCESSORS] = {};
+  uint32_t (*read_)() = nullptr;
+};
+
+class MetricGauge : public Metric
+{
+public:
+  MetricGauge(const char *name, const char *help, const char *labels = nullptr)
+      : Metric(name, help, labels, MetricType::GAUGE) {}
+  MetricGauge(const char *name, const char *help, float (*read)(), const char *labels = nullptr)
+      : Metric(name, help, labels, MetricType::GAUGE), read_(read) {}
+
+  inline void set(float v)
+  {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    __atomic_store_n(&bits_, bits, __ATOMIC_RELAXED);
+  }
+  float value() const;
+
+private:
+  uint32_t bits_ = 0;   // float bits, 0.0f
+  float (*read_)() = nullptr;
+};
+
+class MetricHistogram : public Metric
+{
+public:
+  // `bounds` must be ascending and outlive the metric (static array)
+  MetricHistogram(const char *name, const char *help, const float *bounds, uint8_t count, const char *labels = nullptr);
+
+  void observe(float v);
+  // Cumulative bucket counts (count + 1 entries, last = +Inf), sum
+  void snapshot(uint32_t *cumulative, float &sum) const;
+
+  const float *bounds;
+  uint8_t boundCount;
+
+private:
+  uint32_t buckets_[portNUM_PROCESSORS][METRIC_HIST_MAX_BOUNDS + 1] = {};
+  uint32_t sumBits_[portNUM_PROCESSORS] = {};
+};
+
+class MetricCollector : public Metric
+{
+public:
+  MetricCollector(const char *name, const char *help, MetricType type, MetricCollectFn fn)
+      : Metric(name, help, nullptr, type) { collect = fn; }
+};
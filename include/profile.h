@@ -0,0 +1,107 @@
+#pragma once
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "hal/cpu_hal.h"
+
+// ============================================================
+// ⏱️ Scoped hot-path profiling
+// ------------------------------------------------------------
+//   void read_system_temp()
+//   {
+//     PROFILE_SCOPE("read_system_temp");
+//     ...
+//   }
+//
+// Each PROFILE_SCOPE owns a static ProfilePoint that registers
+// itself on first use. The scope reads the CPU cycle counter on
+// entry and exit and adds the difference to a log2 histogram
+// (bucket b = durations in [2^(b-1), 2^b) cycles) kept per core.
+// Each core only writes its own row, with relaxed 32-bit
+// atomics: no locks, no allocation. The 64-bit cycle sum is a
+// plain add (no native 64-bit atomics on Xtensa), so a task
+// preempted mid-add on the same core can lose one sample from
+// the mean. p50/p99 are interpolated from the buckets; max is
+// exact.
+//
+// Build with -D PROFILE_ENABLED=0 and every PROFILE_SCOPE
+// expands to nothing.
+// ============================================================
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 1
+#endif
+
+#define PROFILE_BUCKETS 33   // 0 cycles, then one per power of two
+
+#if PROFILE_ENABLED
+
+struct ProfilePoint
+{
+  struct Core
+  {
+    uint32_t count;
+    uint32_t maxCycles;
+    uint64_t sumCycles;
+    uint32_t buckets[PROFILE_BUCKETS];
+  };
+
+  const char *name;
+  ProfilePoint *next;
+  Core cores[portNUM_PROCESSORS];
+
+  explicit ProfilePoint(const char *n);
+
+  inline void record(uint32_t cycles)
+  {
+    Core &c = cores[xPortGetCoreID()];
+    uint8_t b = cycles ? 32 - __builtin_clz(cycles) : 0;
+    __atomic_fetch_add(&c.buckets[b], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&c.count, 1, __ATOMIC_RELAXED);
+    c.sumCycles += cycles;
+    uint32_t seen = __atomic_load_n(&c.maxCycles, __ATOMIC_RELAXED);
+    while (cycles > seen &&
+           !__atomic_compare_exchange_n(&c.maxCycles, &seen, cycles, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+  }
+};
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfilePoint &p)
+      : point_(p), core_(xPortGetCoreID()), start_(cpu_hal_get_cycle_count()) {}
+
+  // Cycle counters are per core: drop the sample if the task migrated
+  ~ProfileScope()
+  {
+    uint32_t end = cpu_hal_get_cycle_count();
+    if (xPortGetCoreID() == core_)
+      point_.record(end - start_);
+  }
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  ProfilePoint &point_;
+  int core_;
+  uint32_t start_;
+};
+
+#define PROFILE_CAT2(a, b) a##b
+#define PROFILE_CAT(a, b) PROFILE_CAT2(a, b)
+#define PROFILE_SCOPE(name)                                         \
+  static ProfilePoint PROFILE_CAT(_profPoint, __LINE__)(name);      \
+  ProfileScope PROFILE_CAT(_profScope, __LINE__)(PROFILE_CAT(_profPoint, __LINE__))
+
+#else
+
+#define PROFILE_SCOPE(name) \
+  do                        \
+  {                         \
+  } while (0)
+
+#endif
+
+void fillProfile(JsonDocument &doc);
+String profileReport();
+void profileReset();
@@ -12,23 +12,26 @@
 #include <Preferences.h>
 #include <vector>
 #include "time.h"
+#include "esp_timer.h"
+#include "json_pool.h"
+#include "timer_service.h"
+#include "profile.h"
+#include "metrics.h"
+#include "fan_curve.h"
 
 // ===================== 🌍 NTP / TIME CONFIG =====================
 extern const char *ntpServer;
 extern const long gmtOffset_sec;
 extern const int daylightOffset_sec;
 
-void initTime(const char *ntpServer = "pool.ntp.org", long gmtOffset_sec = 0, int daylightOffset_sec = 0);
 String getDateTime();
 tm getTimeStruct();
 String getTimeOnly();
 String getDateOnly();
 
 // ===================== ⚙️ LOG BUFFER =====================
-extern String logBufferSetup;
-#define LOG_BUFFER_SIZE 4096
-extern char logBufferRuntime[LOG_BUFFER_SIZE];
-extern size_t logHead;
+#define LOG_SETUP_SIZE 4096    // Boot records (first 10 s), append-only
+#define LOG_BUFFER_SIZE 4096   // Runtime records, circular
 
 extern bool WEB_DEBUG;
 
@@ -44,6 +47,7 @@ extern const char *fileSettingsPath;
 extern int system_temp_pin;
 extern int engine_temp_pin;
 extern int fan_control_pin;
+extern int fan_tach_pin;
 
 // ===================== 🌡 TEMPERATURE READ INTERVALS =====================
 extern int system_temp_read_interval;
@@ -82,6 +86,10 @@ struct SystemInfo {
   uint32_t ts;
   float targetPercent;
   int target_pwm;
+  float engineEstC = NAN;   // Kalman estimate, NaN when stale
+  float engineRate = NAN;   // °C/s
+  float systemEstC = NAN;
+  float systemRate = NAN;
 };
 extern SystemInfo sensorData;
 
@@ -97,6 +105,38 @@ enum class FanMode : uint8_t {
   MANUAL
 };
 
+#define FAN_ZONES_MAX 4
+
+enum class ZoneSensor : uint8_t {
+  ENGINE,
+  SYSTEM
+};
+
+// One PWM output with its own sensor, curve, limits and mode.
+// Zone 0 is the original fan: its pin, channel, curve, mode and
+// manual state stay in the top-level fields of SystemSettings;
+// the control loop overlays them on a copy (fan_zones.cpp), and
+// syncPrimaryZone() refreshes zones[0] when settings are loaded.
+struct FanZoneSettings {
+  char name[16] = "";
+  bool enabled = false;
+  int8_t pwm_pin = -1;
+  uint8_t pwm_channel = 0;
+  ZoneSensor sensor = ZoneSensor::ENGINE;
+  int16_t temp_min = 25;          // 0% at or below
+  int16_t temp_max = 50;          // 100% at or above
+  FanCurve curve;                 // >= 2 points: replaces temp_min/temp_max
+  float hyst_rise = 0;            // °C the reading must climb before speeding up
+  float hyst_fall = 2;            // °C it must drop before slowing down
+  uint32_t min_on_ms = 10000;     // AUTO: shortest run once started
+  uint32_t min_off_ms = 5000;     // AUTO: shortest pause once stopped
+  uint8_t min_percent = 0;        // Floor while running
+  uint8_t max_percent = 100;      // Ceiling
+  FanMode mode = FanMode::AUTO;
+  uint8_t manual_percent = 0;
+  bool manual_on = false;
+};
+
 // ===================== 💾 SETTINGS LOAD STATUS =====================
 enum SettingsLoadStatus {
   LOAD_OK,
@@ -110,6 +150,9 @@ enum SettingsLoadStatus {
 extern TaskHandle_t hSensors;
 extern TaskHandle_t hControl;
 extern TaskHandle_t hCan;
+extern TaskHandle_t hOtaPull;
+extern TaskHandle_t hTimers;
+extern TaskHandle_t hMonitor;
 extern QueueHandle_t sensorDataQueue;
 extern SemaphoreHandle_t mtxState;
 extern EventGroupHandle_t egFlags;
@@ -135,6 +178,32 @@ struct StaticRoute {
   String mime;
 };
 
+// Per-route request/latency accounting (route_stats.cpp)
+int routeStatsSlot(const char *path, WebRequestMethod method);
+void routeStatsHandler(int slot, uint32_t us);
+void routeStatsInit(AsyncWebServer &srv);
+void routeStatsOnDisconnect(AsyncWebServerRequest *req, ArDisconnectHandler fn);
+void fillRouteStats(JsonDocument &doc);
+void routeStatsReset();
+String routeStatsReport();
+
+// Wraps a request or body handler so its run time is recorded
+// under (path, method). Works for any handler signature.
+template <typename Fn>
+auto timedView(const char *path, WebRequestMethod method, Fn fn)
+{
+  int slot = routeStatsSlot(path, method);
+  return [slot, fn](auto... args)
+  {
+    uint32_t t0 = micros();
+    fn(args...);
+    routeStatsHandler(slot, micros() - t0);
+  };
+}
+
+// Builds the payload of a JSON endpoint into a caller-owned document
+typedef void (*JsonFiller)(JsonDocument &doc);
+
 // ===================== 🧩 SYSTEM SETTINGS =====================
 struct SystemSettings {
   // --- General ---
@@ -156,10 +225,23 @@ struct SystemSettings {
   uint16_t temp_sample_interval_ms = 1000;
   uint16_t adc_samples = 8;
   String temp_sensor_type = "DS18B20";
+  bool temp_filter_enabled = true;       // Zones follow the Kalman estimate
+  float temp_predict_s = 3.0f;           // ... this far ahead
+  bool temp_fuse_ntc = false;            // NTC also feeds the engine estimate
+  uint16_t temp_stale_ms = 5000;         // No reading -> estimate NaN; NaN this long -> failsafe
 
   // --- Fan Control ---
   volatile FanMode fan_mode;
   uint32_t fan_start_boost_ms = 300;
+  uint8_t fan_start_boost_pct = 60;      // Kick duty when spinning up from 0
+  uint16_t fan_slew_pct_per_s = 25;      // Duty ramp rate, 0 = step immediately
+  bool fan_tach_enabled = false;         // 4-wire fan tach on fan_tach_pin
+  uint8_t fan_tach_ppr = 2;              // Tach pulses per revolution
+  uint16_t fan_rpm_window_ms = 1000;     // RPM averaging window
+  uint16_t fan_stall_ms = 2000;          // Driven without pulses -> stall
+  uint16_t fan_max_rpm = 3000;           // RPM at 100% (closed loop scale)
+  bool fan_closed_loop = false;          // Control RPM instead of duty
+  uint8_t fan_failsafe_pct = 100;        // AUTO output once the sensor is lost
   uint32_t pwm_freq_hz = 12500;
   uint8_t pwm_channel = 0;
   uint8_t pwm_resolution_bits = 8;
@@ -168,6 +250,10 @@ struct SystemSettings {
   uint8_t manual_percent = 0;
   bool manual_on = false;
 
+  // --- Fan Zones ---
+  uint8_t zone_count = 1;
+  FanZoneSettings zones[FAN_ZONES_MAX];
+
   // --- UI Mapping ---
   int ui_system_min = 0;
   int ui_system_max = 100;
@@ -198,12 +284,45 @@ void read_system_temp();
 void read_engine_temp();
 void sendSMS(const String &message);
 void applyManualFan(bool on, uint8_t percent);
+void fanOutputInit(int zone, uint8_t channel);
+int fanOutputSet(int zone, int target);
+void fanOutputTick();
+void fanOutputPoll();
+void fanOutputStop(int zone);
+bool fanOutputIdle(int zone);
+int fanOutputDuty(int zone);
+bool fanOutputBoosting(int zone);
+void syncPrimaryZone(SystemSettings &s);
+void fanZonesInitPwm();
+void fanZonesTick(const SystemInfo &in, float dtS);
+void fillZoneSettings(const SystemSettings &s, JsonArray arr);
+void zonesFromJson(SystemSettings &s, JsonArrayConst arr);
+String fanZonesReport();
+void fanTachInit();
+void fanTachUpdate();
+int fanTachDuty(float percent, float dtS);
+float fanTachRpm();
+uint32_t fanTachStalls();
+void fillTach(JsonObject o);
+void tempFusionConfigure();
+void tempFusionEngine(float c, uint32_t ageMs);
+void tempFusionSystem(float c);
+void tempFusionPublish(SystemInfo &d);
+float tempControl(const SystemInfo &in, ZoneSensor sensor);
+void fillFusion(JsonObject o);
 bool canInit(uint32_t bitRate = 500000);
 void taskSensors(void *);
 void taskControl(void *);
 void taskCan(void *);
+void taskOtaPull(void *);
+void taskMonitor(void *);
+void taskMonitorInit();
+String taskMonitorReport();
+void fillTaskStats(JsonDocument &doc, bool withHistory);
+void heapTrendInit();
+void fillHeapTrend(JsonObject o);
+String heapTrendReport();
 void hbCb(TimerHandle_t);
-bool setInterval(unsigned long intervalMs, void (*fn)());
 int pwm_max();
 
 void processSerialCommands();
@@ -212,23 +331,71 @@ String processCommand(const String &input);
 
 void addLog(const String &msg);
 String getLog();
+void clearLog();
 void logSystemInfo();
-void logMessage(const char *level, const char *fmt, ...);
+void logMessage(const char *level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void formatUptime(char *buf, size_t n);
 
 void settingsApply();
 void loadSettings();
 bool settingsSaveToFS();
+void settingsTouch();
+uint32_t settingsRevision();
 SettingsLoadStatus settingsLoadFromFS();
 bool settingsFromJson(const String &body);
 String settingsToJson(const SystemSettings &s);
 String settingsDefaultsJson();
 void fillJsonFrom(const SystemSettings &s, JsonDocument &doc);
+void fillJsonFrom(const SystemSettings &s, JsonObject doc);
 void fillFromJson(SystemSettings &s, const JsonDocument &doc);
 
 void setupTime();
+void timeService();
+bool timeIsValid();
+const char *timeSourceName();
+String timeReport();
 void printLocalTime();
 void saveNetwork(const String &ssid, const String &password);
 bool tryConnect(const String &ssid, const String &password);
+void fillWifiMetrics(JsonObject o);
+bool requestWifiScan(bool force = false);
+void fillWifiScan(JsonDocument &doc);
+String wifiStatsReport();
+
+// ===================== 📤 JSON RESPONSES =====================
+void sendJson(AsyncWebServerRequest *req, const JsonDocument &doc, int code = 200);
+void sendJson(AsyncWebServerRequest *req, JsonFiller fill, int code = 200);
+void sendText(AsyncWebServerRequest *req, int code, const char *type, TextBuilder &text);
+void sendConst(AsyncWebServerRequest *req, int code, const char *type, const char *text);   // `text` must be static
+String jsonStatsReport();
+String jsonBenchReport(int iterations);
+String formatBenchReport(int iterations);
+void fillJson(JsonDocument &json);
+void fillMemInfo(JsonDocument &doc);
+void fillWifiInfo(JsonDocument &doc);
+void fillSensors(JsonDocument &doc);
+void fillSettings(JsonDocument &doc);
+void fillSensorValues(JsonObject o);
+void fillZones(JsonDocument &doc);
+
+// ===================== 🔁 OTA PIPELINE =====================
+// `owner` identifies the session: only the caller that opened it
+// may write to it, commit it or abort it
+bool otaBegin(const void *owner, int command, size_t size, const char *sha256Hex, bool dryRun = false);
+bool otaWrite(const void *owner, const uint8_t *data, size_t len);
+bool otaEnd(const void *owner);
+void otaAbort(const void *owner, const char *reason);
+void otaRelease(const void *owner);
+bool otaOwnedBy(const void *owner);
+bool otaInProgress();
+const char *otaError();
+void fillOtaStatus(JsonDocument &doc);
+void scheduleRestart(uint32_t delayMs);
+void otaPullNow();
+bool otaPullBusy();
+void deltaHashRunning();
+void fillOtaPullStatus(JsonObject o);
+String otaPullReport();
 
 // ===================== 🧠 WEB HANDLERS =====================
 void sysInfo(AsyncWebServerRequest *req);
@@ -241,6 +408,8 @@ void handleJson(AsyncWebServerRequest *request);
 void get_settings(AsyncWebServerRequest *request);
 void handleUpdateFirmware(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
 void handleUpdateLittleFS(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
+void handleUpdateDelta(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final);
+void otaUploadDone(AsyncWebServerRequest *request);
 void handleFSStatus(AsyncWebServerRequest *request);
 void handle_log(AsyncWebServerRequest *request);
 void ota_status(AsyncWebServerRequest *request);
@@ -249,16 +418,24 @@ void log_function_execution(AsyncWebServerRequest *request);
 void wifi_info(AsyncWebServerRequest *request);
 void alarma(AsyncWebServerRequest *request);
 void files_list(AsyncWebServerRequest *request);
+void apiFiles(AsyncWebServerRequest *request);
 void mem_info(AsyncWebServerRequest *request);
 void fan(AsyncWebServerRequest *request);
 void web_restart(AsyncWebServerRequest *request);
 void readFile(AsyncWebServerRequest *request);
+const char *mimeTypeFor(const char *path);
 void toggleFan(AsyncWebServerRequest *req);
 void setMode(AsyncWebServerRequest *request);
 void settings(AsyncWebServerRequest *req);
 void apiSettings(AsyncWebServerRequest *req);
 void apiSettingsDefault(AsyncWebServerRequest *req);
 void apiSensors(AsyncWebServerRequest *req);
+void apiZones(AsyncWebServerRequest *req);
+void apiStatus(AsyncWebServerRequest *req);
+void apiTasks(AsyncWebServerRequest *req);
+void apiProfile(AsyncWebServerRequest *req);
+void apiRouteStats(AsyncWebServerRequest *req);
+void handleMetrics(AsyncWebServerRequest *request);
 void favicon(AsyncWebServerRequest *req);
 void formatFS(AsyncWebServerRequest *request);
 void deleteFile(AsyncWebServerRequest *request);
@@ -284,6 +461,9 @@ void setManualPercentView(AsyncWebServerRequest *request);
 #define CHECK_AND_LOG(expr, okmsg, errmsg) \
   do { if (expr) { LOGI okmsg; } else { LOGE errmsg; } } while (0)
 
-static inline uint32_t ts_ms() { return (uint32_t)millis(); }
+static inline uint32_t ts_ms() { return (uint32_t)millis(); }   // Wraps after ~49 days
+// Monotonic 64-bit clock since boot (esp_timer), does not wrap in practice
+static inline int64_t mono_us() { return esp_timer_get_time(); }
+static inline uint64_t mono_ms() { return (uint64_t)(esp_timer_get_time() / 1000); }
 static inline float heap_kb() { return ESP.getFreeHeap() / 1024.0f; }
 
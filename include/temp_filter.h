@@ -0,0 +1,117 @@
+#pragma once
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================
+// 🌡️ Temperature estimator (2-state Kalman)
+// ------------------------------------------------------------
+// State: temperature T and its rate of change R (°C/s), with a
+// constant-rate model whose rate drifts as a random walk
+// (spectral density q).
+//
+// Every reading comes with its own variance and age:
+// - DS18B20: low noise, but the value belongs to the moment the
+//   conversion started, ~750 ms before it is read. It is applied
+//   as a measurement of T - R·age, so the lag does not drag the
+//   estimate behind a rising temperature.
+// - NTC: noisier, no lag, many samples.
+// Readings of either sensor refine the same state.
+//
+// at(nowMs) extrapolates to any moment; predicted(h) looks h
+// seconds further ahead. After staleMs without a reading the
+// estimate reports NaN instead of coasting on forever.
+//
+// Fixed size, no allocation, no Arduino dependency: the same
+// code runs on the device (temp_fusion.cpp) and in the host
+// simulation (temp_filter_sim.cpp).
+// ============================================================
+class TempKalman
+{
+public:
+  float q = 0.002f;          // Rate random walk, (°C/s)² per s
+  uint32_t staleMs = 5000;   // No reading for this long -> NaN
+
+  void reset() { ready_ = false; }
+
+  // `variance` in °C²; `ageS` = how old the value already is
+  void update(float z, float variance, uint32_t nowMs, float ageS = 0)
+  {
+    if (isnan(z))
+      return;
+    if (!ready_)
+    {
+      t_ = z;
+      r_ = 0;
+      p00_ = variance;
+      p01_ = 0;
+      p11_ = 1.0f;   // Rate unknown: ±1 °C/s
+      ms_ = lastMs_ = nowMs;
+      ready_ = true;
+      return;
+    }
+    predict(nowMs);
+
+    // z ~ T - age·R  ->  H = [1, -age]
+    float h1 = -ageS;
+    float ph0 = p00_ + p01_ * h1;    // (P·Hᵀ)₀
+    float ph1 = p01_ + p11_ * h1;    // (P·Hᵀ)₁
+    float s = ph0 + h1 * ph1 + variance;
+    if (!(s > 0))
+      return;
+    float k0 = ph0 / s, k1 = ph1 / s;
+    float y = z - (t_ + h1 * r_);
+
+    t_ += k0 * y;
+    r_ += k1 * y;
+
+    // P = (I - K·H)·P
+    float n00 = p00_ - k0 * ph0;
+    float n01 = p01_ - k0 * ph1;
+    float n11 = p11_ - k1 * ph1;
+    p00_ = n00;
+    p01_ = n01;
+    p11_ = n11;
+    lastMs_ = nowMs;
+  }
+
+  bool valid(uint32_t nowMs) const { return ready_ && nowMs - lastMs_ <= staleMs; }
+
+  // Estimate at `nowMs` (NaN when stale)
+  float at(uint32_t nowMs) const
+  {
+    if (!valid(nowMs))
+      return NAN;
+    return t_ + r_ * (int32_t)(nowMs - ms_) / 1000.0f;
+  }
+
+  float rate(uint32_t nowMs) const { return valid(nowMs) ? r_ : NAN; }
+
+  float predicted(uint32_t nowMs, float horizonS) const
+  {
+    return at(nowMs) + rate(nowMs) * horizonS;
+  }
+
+  // 1σ of the temperature estimate at the last reading
+  float sigma() const { return ready_ ? sqrtf(p00_ > 0 ? p00_ : 0) : NAN; }
+
+private:
+  void predict(uint32_t nowMs)
+  {
+    float dt = (int32_t)(nowMs - ms_) / 1000.0f;
+    if (dt <= 0)
+      return;
+    t_ += r_ * dt;
+    // P = F·P·Fᵀ + Q, F = [1 dt; 0 1], Q = q·[dt³/3 dt²/2; dt²/2 dt]
+    float dt2 = dt * dt;
+    p00_ += 2 * dt * p01_ + dt2 * p11_ + q * dt2 * dt / 3;
+    p01_ += dt * p11_ + q * dt2 / 2;
+    p11_ += q * dt;
+    ms_ = nowMs;
+  }
+
+  bool ready_ = false;
+  float t_ = 0, r_ = 0;
+  float p00_ = 0, p01_ = 0, p11_ = 0;
+  uint32_t ms_ = 0;       // Time of the state
+  uint32_t lastMs_ = 0;   // Last reading
+};
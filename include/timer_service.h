@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+#include "timer_wheel.h"
+
+// ============================================================
+// ⏲️ Timer service
+// ------------------------------------------------------------
+// One TimerWheel ticking in milliseconds, run by taskTimers.
+// The task sleeps until the next expiry and is woken by a task
+// notification when a timer is added, so nothing polls.
+//
+//   TimerId id = setTimeout([] { ... }, 500);
+//   TimerId hb = setInterval([] { ... }, 1000);
+//   clearTimer(id);
+//
+// Safe to call from other tasks and from ISRs (the wheel is
+// guarded by a spinlock critical section). Callbacks run on
+// taskTimers and must be short: no blocking I/O, no delays.
+// Captures are stored inline (TIMER_CALLBACK_SIZE bytes).
+// ============================================================
+#ifndef TIMER_SERVICE_CAPACITY
+#define TIMER_SERVICE_CAPACITY 32       // Concurrent timers
+#endif
+#ifndef TIMER_SERVICE_MAX_SLEEP_MS
+#define TIMER_SERVICE_MAX_SLEEP_MS 1000 // Upper bound between wheel advances
+#endif
+
+struct TimerSpinLock
+{
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+  void lock() { portENTER_CRITICAL_SAFE(&mux); }
+  void unlock() { portEXIT_CRITICAL_SAFE(&mux); }
+};
+
+typedef TimerWheel<TIMER_SERVICE_CAPACITY, TimerSpinLock> ServiceTimerWheel;
+extern ServiceTimerWheel timerWheel;
+
+void timerServiceWake();
+void taskTimers(void *);
+String timerReport();
+
+// Expiries are absolute millis(): the wheel may lag real time by
+// up to one sleep, so a relative delay would fire early.
+template <typename F>
+TimerId setTimeout(F fn, uint32_t delayMs)
+{
+  TimerId id = timerWheel.addAt(millis() + delayMs, 0, fn);
+  timerServiceWake();
+  return id;
+}
+
+template <typename F>
+TimerId setInterval(F fn, uint32_t periodMs)
+{
+  if (!periodMs)
+    periodMs = 1;
+  TimerId id = timerWheel.addAt(millis() + periodMs, periodMs, fn);
+  timerServiceWake();
+  return id;
+}
+
+inline bool clearTimer(TimerId id)
+{
+  return timerWheel.cancel(id);
+}
@@ -0,0 +1,366 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <type_traits>
+
+// ============================================================
+// 🕒 Hierarchical timing wheel
+// ------------------------------------------------------------
+// Four levels of 64 slots, 1 tick per slot at level 0
+// (64^4 ticks ≈ 4.6 h at 1 ms; longer delays are parked in the
+// top level and re-cascaded). Timers live in a fixed node pool
+// linked into per-slot lists, so:
+//   - insert / cancel are O(1)
+//   - expiry is O(1) amortized (a timer cascades at most once
+//     per level)
+//   - advance() jumps straight to the next occupied slot using
+//     per-level occupancy bitmaps
+//
+// No Arduino/FreeRTOS dependency: the same code runs in the
+// device timer service (timer_service.cpp) and in the host
+// benchmark (timer_wheel_bench.cpp). Thread safety comes from
+// the Lock policy; the default does nothing.
+// ============================================================
+#ifndef TIMER_CALLBACK_SIZE
+#define TIMER_CALLBACK_SIZE 16   // Inline capture bytes per timer
+#endif
+
+// Handle: low 16 bits = pool slot, high 16 bits = generation.
+// 0 is never a valid handle.
+typedef uint32_t TimerId;
+
+// ============================================================
+// 🧩 TimerCallback - small-buffer callable, never allocates
+// ------------------------------------------------------------
+// Accepts plain functions and lambdas whose captures fit in
+// TIMER_CALLBACK_SIZE bytes and are trivially copyable
+// (pointers, ints, handles). Anything larger fails to compile
+// instead of silently going to the heap.
+// ============================================================
+class TimerCallback
+{
+public:
+  TimerCallback() = default;
+
+  template <typename F>
+  void set(F fn)
+  {
+    static_assert(sizeof(F) <= TIMER_CALLBACK_SIZE, "Timer callback capture too large");
+    static_assert(alignof(F) <= alignof(void *), "Timer callback capture over-aligned");
+    static_assert(std::is_trivially_copyable<F>::value, "Timer callback capture must be trivially copyable");
+    new (buf_) F(fn);
+    invoke_ = [](void *p) { (*static_cast<F *>(p))(); };
+  }
+
+  void operator()() { invoke_(buf_); }
+  explicit operator bool() const { return invoke_ != nullptr; }
+  void reset() { invoke_ = nullptr; }
+
+private:
+  alignas(void *) uint8_t buf_[TIMER_CALLBACK_SIZE];
+  void (*invoke_)(void *) = nullptr;
+};
+
+struct TimerNoLock
+{
+  void lock() {}
+  void unlock() {}
+};
+
+// ============================================================
+// 🎡 TimerWheel<Capacity, Lock>
+// ------------------------------------------------------------
+// add()/cancel() may be called from any context the Lock covers.
+// advance() runs the callbacks with the lock released, so a
+// callback may add or cancel timers (including itself).
+// ============================================================
+template <uint16_t Capacity, typename Lock = TimerNoLock>
+class TimerWheel
+{
+  static_assert(Capacity > 0 && Capacity < 0xFFFF, "Capacity must fit a 16-bit index");
+
+public:
+  static constexpr int LEVELS = 4;
+  static constexpr int BITS = 6;
+  static constexpr int SLOTS = 1 << BITS;
+  static constexpr uint32_t MAX_SPAN = (1UL << (LEVELS * BITS)) - 1;
+
+  struct Stats
+  {
+    uint16_t active;
+    uint16_t highWater;
+    uint32_t fired;
+    uint32_t cascaded;
+    uint32_t cancelled;
+    uint32_t poolFull;
+  };
+
+  explicit TimerWheel(uint32_t now = 0) { reset(now); }
+
+  void reset(uint32_t now)
+  {
+    now_ = now;
+    memset(heads_, 0xFF, sizeof(heads_));
+    memset(occupied_, 0, sizeof(occupied_));
+    memset(&stats_, 0, sizeof(stats_));
+    free_ = 0;
+    for (uint16_t i = 0; i < Capacity; i++)
+    {
+      nodes_[i].next = i + 1 < Capacity ? i + 1 : NIL;
+      nodes_[i].gen = 1;
+      nodes_[i].where = FREE;
+    }
+  }
+
+  // One-shot after `delay` ticks (period 0) or repeating every
+  // `period` ticks. Returns 0 when the pool is exhausted.
+  template <typename F>
+  TimerId add(uint32_t delay, uint32_t period, F fn)
+  {
+    return addAt(now_ + (delay ? delay : 1), period, fn);
+  }
+
+  // Same, with an absolute expiry tick. Expiries at or before
+  // the wheel's current tick fire on the next advance().
+  template <typename F>
+  TimerId addAt(uint32_t expires, uint32_t period, F fn)
+  {
+    lock_.lock();
+    if (free_ == NIL)
+    {
+      stats_.poolFull++;
+      lock_.unlock();
+      return 0;
+    }
+    uint16_t i = free_;
+    Node &n = nodes_[i];
+    free_ = n.next;
+
+    n.cb.set(fn);
+    n.period = period;
+    n.expires = (int32_t)(expires - now_) > 0 ? expires : now_ + 1;   // Never the slot being run
+    link(i);
+
+    if (++stats_.active > stats_.highWater)
+      stats_.highWater = stats_.active;
+    TimerId id = makeId(i, n.gen);
+    lock_.unlock();
+    return id;
+  }
+
+  // False if the timer already fired (one-shot) or was cancelled.
+  bool cancel(TimerId id)
+  {
+    uint16_t i = id & 0xFFFF;
+    if (!id || i >= Capacity)
+      return false;
+
+    lock_.lock();
+    Node &n = nodes_[i];
+    bool ok = n.gen == (id >> 16) && n.where != FREE;
+    if (ok)
+    {
+      if (n.where != RUNNING)
+        unlink(i);
+      release(i);
+      stats_.cancelled++;
+    }
+    lock_.unlock();
+    return ok;
+  }
+
+  bool pending(TimerId id)
+  {
+    uint16_t i = id & 0xFFFF;
+    if (!id || i >= Capacity)
+      return false;
+    lock_.lock();
+    bool ok = nodes_[i].gen == (id >> 16) && nodes_[i].where != FREE;
+    lock_.unlock();
+    return ok;
+  }
+
+  // Run everything due up to and including `now`. Returns the
+  // number of callbacks invoked.
+  uint32_t advance(uint32_t now)
+  {
+    uint32_t ran = 0;
+    lock_.lock();
+    while ((int32_t)(now - now_) > 0)
+    {
+      // Skip empty ticks: nothing can fire or cascade before nextDue
+      uint32_t skip = nextDueLocked() - 1;
+      uint32_t left = now - now_;
+      if (skip >= left)
+      {
+        now_ = now;
+        break;
+      }
+      now_ += skip + 1;
+
+      // Cascade upper levels whose index just rolled over
+      for (int lvl = 1; lvl < LEVELS; lvl++)
+      {
+        if (now_ & ((1UL << (lvl * BITS)) - 1))
+          break;
+        cascade(lvl, (now_ >> (lvl * BITS)) & (SLOTS - 1));
+      }
+
+      // Fire level 0; popping one node at a time lets callbacks
+      // cancel other timers in the same slot
+      uint16_t slot = now_ & (SLOTS - 1);
+      while (heads_[0][slot] != NIL)
+      {
+        uint16_t i = heads_[0][slot];
+        unlink(i);
+        Node &n = nodes_[i];
+        n.where = RUNNING;
+        uint16_t gen = n.gen;
+        TimerCallback cb = n.cb;
+
+        lock_.unlock();
+        cb();
+        ran++;
+        lock_.lock();
+
+        stats_.fired++;
+        if (n.gen != gen || n.where != RUNNING)
+          continue;   // Cancelled from inside the callback
+        if (n.period)
+        {
+          n.expires += n.period;
+          if ((int32_t)(n.expires - now_) <= 0)
+            n.expires = now_ + n.period;   // Fell behind: don't burst
+          link(i);
+        }
+        else
+          release(i);
+      }
+    }
+    lock_.unlock();
+    return ran;
+  }
+
+  // Ticks until the next fire or cascade (a lower bound on the
+  // next expiry). MAX_SPAN + 1 when the wheel is empty.
+  uint32_t nextDue()
+  {
+    lock_.lock();
+    uint32_t d = nextDueLocked();
+    lock_.unlock();
+    return d;
+  }
+
+  uint32_t now() const { return now_; }
+  Stats stats() const { return stats_; }
+  static constexpr uint16_t capacity() { return Capacity; }
+
+private:
+  static constexpr uint16_t NIL = 0xFFFF;
+  static constexpr uint8_t FREE = 0xFF;
+  static constexpr uint8_t RUNNING = 0xFE;
+
+  struct Node
+  {
+    TimerCallback cb;
+    uint32_t expires;
+    uint32_t period;
+    uint16_t prev, next;
+    uint16_t gen;
+    uint8_t where;   // Level 0..3, FREE or RUNNING
+    uint8_t slot;
+  };
+
+  static TimerId makeId(uint16_t i, uint16_t gen) { return ((uint32_t)gen << 16) | i; }
+
+  void link(uint16_t i)
+  {
+    Node &n = nodes_[i];
+    uint32_t delta = n.expires - now_;
+    uint32_t at = n.expires;
+    if (delta > MAX_SPAN)
+      at = now_ + MAX_SPAN;   // Park in the top level, re-cascade later
+
+    int lvl = 0;
+    while (lvl < LEVELS - 1 && (at - now_) >= (1UL << ((lvl + 1) * BITS)))
+      lvl++;
+    uint8_t slot = (at >> (lvl * BITS)) & (SLOTS - 1);
+
+    n.where = lvl;
+    n.slot = slot;
+    n.prev = NIL;
+    n.next = heads_[lvl][slot];
+    if (n.next != NIL)
+      nodes_[n.next].prev = i;
+    heads_[lvl][slot] = i;
+    occupied_[lvl] |= 1ULL << slot;
+  }
+
+  void unlink(uint16_t i)
+  {
+    Node &n = nodes_[i];
+    if (n.prev != NIL)
+      nodes_[n.prev].next = n.next;
+    else
+      heads_[n.where][n.slot] = n.next;
+    if (n.next != NIL)
+      nodes_[n.next].prev = n.prev;
+    if (heads_[n.where][n.slot] == NIL)
+      occupied_[n.where] &= ~(1ULL << n.slot);
+  }
+
+  void release(uint16_t i)
+  {
+    Node &n = nodes_[i];
+    n.cb.reset();
+    n.where = FREE;
+    if (++n.gen == 0)
+      n.gen = 1;   // Keep handles non-zero
+    n.next = free_;
+    free_ = i;
+    stats_.active--;
+  }
+
+  void cascade(int lvl, uint8_t slot)
+  {
+    uint16_t i = heads_[lvl][slot];
+    heads_[lvl][slot] = NIL;
+    occupied_[lvl] &= ~(1ULL << slot);
+    while (i != NIL)
+    {
+      uint16_t next = nodes_[i].next;
+      link(i);
+      stats_.cascaded++;
+      i = next;
+    }
+  }
+
+  uint32_t nextDueLocked() const
+  {
+    uint32_t best = MAX_SPAN + 1;
+    for (int lvl = 0; lvl < LEVELS; lvl++)
+    {
+      if (!occupied_[lvl])
+        continue;
+      int shift = lvl * BITS;
+      uint8_t cur = (now_ >> shift) & (SLOTS - 1);
+      // Rotate so bit 0 is the slot after `cur`
+      uint8_t r = (cur + 1) & (SLOTS - 1);
+      uint64_t m = r ? (occupied_[lvl] >> r) | (occupied_[lvl] << (SLOTS - r)) : occupied_[lvl];
+      uint32_t d = __builtin_ctzll(m) + 1;   // 1..64 slots ahead
+      uint32_t ticks = (d << shift) - (now_ & ((1UL << shift) - 1));
+      if (ticks < best)
+        best = ticks;
+    }
+    return best;
+  }
+
+  Node nodes_[Capacity];
+  uint16_t heads_[LEVELS][SLOTS];
+  uint64_t occupied_[LEVELS];
+  uint16_t free_;
+  uint32_t now_;
+  Stats stats_;
+  Lock lock_;
+};
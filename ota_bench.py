@@ -0,0 +1,77 @@
+# ota_bench.py
+#
+# Compara upload-ul OTA raw vs gzip pe un device real, fara reboot.
+# Ambele variante sunt trimise cu ?dry_run=1: imaginea e primita,
+# decomprimata si trecuta prin SHA-256, dar nu se scrie nimic in flash
+# (deci si /updatefs e sigur; write ramane 0).
+#
+#   python ota_bench.py <device-ip> firmware.bin [/firmware_update|/updatefs]
+#
+# Pentru fiecare varianta afiseaza: bytes pe fir, timp total (host),
+# timp receive/write/hash/inflate raportat de /ota_status si heap peak.
+
+import gzip
+import hashlib
+import json
+import sys
+import time
+import urllib.request
+import uuid
+
+
+def post_file(url, field, filename, payload):
+    boundary = uuid.uuid4().hex
+    head = (f"--{boundary}\r\n"
+            f'Content-Disposition: form-data; name="{field}"; filename="{filename}"\r\n'
+            f"Content-Type: application/octet-stream\r\n\r\n").encode()
+    tail = f"\r\n--{boundary}--\r\n".encode()
+    body = head + payload + tail
+    req = urllib.request.Request(url, data=body, method="POST")
+    req.add_header("Content-Type", f"multipart/form-data; boundary={boundary}")
+    with urllib.request.urlopen(req, timeout=300) as res:
+        return res.status, res.read().decode(errors="replace")
+
+
+def ota_status(host):
+    with urllib.request.urlopen(f"http://{host}/ota_status", timeout=10) as res:
+        return json.loads(res.read())
+
+
+def run(host, route, name, filename, payload, digest):
+    url = f"http://{host}{route}?dry_run=1&sha256={digest}"
+    t = time.time()
+    code, text = post_file(url, "image", filename, payload)
+    wall = time.time() - t
+    st = ota_status(host)
+    tm = st.get("timing", {})
+    ok = "✅" if code == 200 else "❌"
+    print(f"{ok} {name:5} wire={st.get('wire_bytes', len(payload)):>8}B  total={wall * 1000:7.0f}ms  "
+          f"receive={tm.get('receive_ms', 0):6}ms write={tm.get('write_ms', 0):5}ms "
+          f"hash={tm.get('hash_ms', 0):4}ms inflate={tm.get('inflate_ms', 0):5}ms  "
+          f"heap_peak={st.get('heap_peak', 0)}B")
+    if code != 200:
+        print(f"   {text}")
+    return wall
+
+
+def main(argv):
+    if len(argv) < 3:
+        print("usage: ota_bench.py <device-ip> image.bin [/firmware_update|/updatefs]")
+        return 2
+
+    host, path = argv[1], argv[2]
+    route = argv[3] if len(argv) > 3 else "/firmware_update"
+    with open(path, "rb") as f:
+        raw = f.read()
+    packed = gzip.compress(raw, 9)
+    digest = hashlib.sha256(raw).hexdigest()
+
+    print(f"📦 {path}: raw {len(raw)} B, gzip {len(packed)} B ({100.0 * len(packed) / len(raw):.1f}%)")
+    t_raw = run(host, route, "raw", "image.bin", raw, digest)
+    t_gz = run(host, route, "gzip", "image.bin.gz", packed, digest)
+    print(f"⏱️ gzip upload is {t_raw / t_gz:.2f}x the speed of raw")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
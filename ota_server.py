@@ -0,0 +1,99 @@
+# ota_server.py
+#
+# Server HTTP local care imita un server OTA pentru taskOtaPull.
+# Serveste /manifest.json si imaginea, cu suport pentru Range.
+#
+#   python ota_server.py firmware.bin --version 14 [--port 8000]
+#                        [--drop-after 200000] [--ignore-range]
+#
+# Pe device: ota_url = http://<ip-pc>:8000/manifest.json, apoi
+# `ota_check` in consola (sau ota_enabled = true).
+#
+#   --drop-after N   inchide conexiunea dupa N bytes (o singura data),
+#                    ca sa testezi reluarea cu Range
+#   --ignore-range   raspunde mereu 200 cu tot fisierul
+
+import argparse
+import hashlib
+import json
+import os
+import re
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+def make_handler(args, image, name):
+    state = {"dropped": False}
+    manifest = json.dumps({
+        "version": args.version,
+        "url": name,
+        "size": len(image),
+        "sha256": hashlib.sha256(image).hexdigest(),
+    }).encode()
+
+    class Handler(BaseHTTPRequestHandler):
+        def do_GET(self):
+            if self.path.split("?")[0] == "/manifest.json":
+                self.reply(200, manifest, "application/json")
+            elif self.path.split("?")[0] == "/" + name:
+                self.send_image()
+            else:
+                self.reply(404, b"not found", "text/plain")
+
+        def reply(self, code, body, mime, extra=None):
+            self.send_response(code)
+            self.send_header("Content-Type", mime)
+            self.send_header("Content-Length", str(len(body)))
+            for k, v in (extra or {}).items():
+                self.send_header(k, v)
+            self.end_headers()
+            self.wfile.write(body)
+
+        def send_image(self):
+            start = 0
+            m = re.match(r"bytes=(\d+)-", self.headers.get("Range", ""))
+            if m and not args.ignore_range:
+                start = int(m.group(1))
+                if start >= len(image):
+                    self.reply(416, b"", "text/plain", {"Content-Range": f"bytes */{len(image)}"})
+                    return
+            body = image[start:]
+
+            self.send_response(206 if start else 200)
+            self.send_header("Content-Type", "application/octet-stream")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("Accept-Ranges", "bytes")
+            if start:
+                self.send_header("Content-Range", f"bytes {start}-{len(image) - 1}/{len(image)}")
+            self.end_headers()
+
+            if args.drop_after and not state["dropped"] and start < args.drop_after:
+                state["dropped"] = True
+                self.wfile.write(body[:args.drop_after - start])
+                print(f"✂️  Dropped connection at byte {args.drop_after}")
+                self.close_connection = True
+                return
+            self.wfile.write(body)
+
+    return Handler
+
+
+def main():
+    p = argparse.ArgumentParser(description="Local OTA manifest/image server")
+    p.add_argument("image")
+    p.add_argument("--version", type=int, required=True)
+    p.add_argument("--port", type=int, default=8000)
+    p.add_argument("--drop-after", type=int, default=0)
+    p.add_argument("--ignore-range", action="store_true")
+    args = p.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    name = os.path.basename(args.image)
+
+    print(f"📡 Serving {name} ({len(image)} B, version {args.version}) on :{args.port}")
+    print(f"   manifest: http://<this-pc>:{args.port}/manifest.json")
+    ThreadingHTTPServer(("", args.port), make_handler(args, image, name)).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
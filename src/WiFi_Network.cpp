@@ -3,35 +3,213 @@
 #include <WiFi.h>
 #include <Preferences.h>
 #include <vector>
+#include <algorithm>
+
+// ============================================================
+// 📶 Wi-Fi association
+// ------------------------------------------------------------
+// Boot:     join the cached BSSID/channel of the last good AP
+//           directly; if that fails, scan once and try saved
+//           networks strongest-first (also by BSSID/channel).
+// Runtime:  a disconnect event arms a backoff timer that rejoins
+//           the cached AP; after WIFI_CACHED_RETRIES failures an
+//           async scan picks the strongest saved network again.
+// Attempts end on GOT_IP or DISCONNECTED events, never by polling.
+//
+// The background state machine runs on taskTimers only: the
+// event handler queues what it saw (linkEvents) and the backoff
+// is a timer-service timeout, so wifiLink has a single writer.
+// ============================================================
+
+#ifndef WIFI_FAST_TIMEOUT_MS
+#define WIFI_FAST_TIMEOUT_MS 4000      // Direct join of the cached AP
+#endif
+#ifndef WIFI_CONNECT_TIMEOUT_MS
+#define WIFI_CONNECT_TIMEOUT_MS 8000   // Any other single attempt
+#endif
+#define WIFI_CACHED_RETRIES 3          // Background rejoins before rescanning
+#define WIFI_BACKOFF_MAX_MS 60000
+#define WIFI_LINK_EVENTS 8             // Queued for taskTimers between drains
+
+#define WIFI_BIT_GOT_IP BIT0
+#define WIFI_BIT_FAIL BIT1
 
 struct WifiCred {
   String ssid;
   String password;
+  bool isDefault;   // Compiled-in WIFI_SSID, saved to NVS on first success
 };
 
 std::vector<WifiCred> savedNetworks;
 
+struct WifiCandidate {
+  size_t cred;        // Index into savedNetworks
+  int32_t rssi;
+  int32_t channel;
+  uint8_t bssid[6];
+};
+
+// Last AP we got an IP from (NVS: last_ssid/last_pass/last_bssid/last_chan)
+static struct {
+  String ssid;
+  String pass;
+  uint8_t bssid[6];
+  uint8_t channel;
+  bool valid;
+} lastAp;
+
+enum class LinkState : uint8_t {
+  CONNECTING,    // Foreground attempt (boot, wifi_set) owns the radio
+  UP,
+  BACKOFF,
+  REJOINING,
+  SCANNING
+};
+
+static struct {
+  LinkState state = LinkState::CONNECTING;
+  uint32_t bootMs = 0;          // initWiFi() start → IP
+  const char *bootMethod = "none";
+  uint8_t bootAttempts = 0;
+  uint32_t scanMs = 0;          // Last scan duration
+  uint32_t lastConnectMs = 0;   // Last background reconnect (link down → IP)
+  uint32_t reconnects = 0;
+  uint32_t disconnects = 0;
+  uint8_t lastReason = 0;       // wifi_err_reason_t of the last disconnect (event task)
+  uint8_t failures = 0;         // Consecutive background failures
+  uint32_t downSince = 0;
+  String pendingSsid;           // Network of the background attempt in flight
+  String pendingPass;
+} wifiLink;
+
+static EventGroupHandle_t wifiEvents = nullptr;
+static TimerId reconnectTimer = 0;
+
+struct LinkEvent {
+  arduino_event_id_t event;
+  uint8_t reason;
+};
+static QueueHandle_t linkEvents = nullptr;
+
+// =======================================================
+// 🔍 Scan result cache (/wifi_info)
+// -------------------------------------------------------
+// Scans run asynchronously; SCAN_DONE copies the results
+// here, and /wifi_info answers from the copy at once.
+// =======================================================
+#ifndef WIFI_SCAN_MAX_AGE_MS
+#define WIFI_SCAN_MAX_AGE_MS 30000   // Older results trigger a background rescan
+#endif
+#define WIFI_SCAN_CACHE_MAX 24
+
+struct ScanEntry {
+  char ssid[33];
+  int8_t rssi;
+  uint8_t channel;
+  uint8_t encryption;
+  uint8_t bssid[6];
+};
+
+static struct {
+  ScanEntry entries[WIFI_SCAN_CACHE_MAX];
+  uint8_t count = 0;
+  uint16_t found = 0;          // APs seen by the scan (may exceed count)
+  uint32_t at = 0;             // millis() when the last scan finished
+  uint32_t startedAt = 0;
+  uint32_t durationMs = 0;
+  volatile bool scanning = false;
+} scanCache;
+
+static SemaphoreHandle_t scanMutex = nullptr;
+
+// Keeps the strongest WIFI_SCAN_CACHE_MAX results of the last scan
+static void cacheScanResults(int found)
+{
+  if (!scanMutex || xSemaphoreTake(scanMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+    return;
+
+  scanCache.count = 0;
+  scanCache.found = max(found, 0);
+  for (int i = 0; i < found; i++)
+  {
+    int8_t rssi = WiFi.RSSI(i);
+    uint8_t slot = scanCache.count;
+    if (slot == WIFI_SCAN_CACHE_MAX)
+    {
+      // Full: replace the weakest entry if this one is stronger
+      slot = 0;
+      for (uint8_t k = 1; k < WIFI_SCAN_CACHE_MAX; k++)
+        if (scanCache.entries[k].rssi < scanCache.entries[slot].rssi)
+          slot = k;
+      if (scanCache.entries[slot].rssi >= rssi)
+        continue;
+    }
+    else
+      scanCache.count++;
+
+    ScanEntry &e = scanCache.entries[slot];
+    strlcpy(e.ssid, WiFi.SSID(i).c_str(), sizeof(e.ssid));
+    e.rssi = rssi;
+    e.channel = WiFi.channel(i);
+    e.encryption = WiFi.encryptionType(i);
+    memcpy(e.bssid, WiFi.BSSID(i), 6);
+  }
+
+  std::sort(scanCache.entries, scanCache.entries + scanCache.count, [](const ScanEntry &a, const ScanEntry &b)
+            { return a.rssi > b.rssi; });
+  scanCache.at = millis();
+  scanCache.durationMs = scanCache.at - scanCache.startedAt;
+  xSemaphoreGive(scanMutex);
+}
+
+static bool startAsyncScan()
+{
+  scanCache.scanning = true;
+  scanCache.startedAt = millis();
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED)
+  {
+    scanCache.scanning = false;
+    return false;
+  }
+  return true;
+}
+
 // =======================================================
 // 🔹 Load saved Wi-Fi networks from NVS
 // =======================================================
 void loadSavedNetworks()
 {
-  prefs.begin("wifi_networks", true);
-  int count = prefs.getInt("count", 0);
+  Preferences nvs;
+  nvs.begin("wifi_networks", true);
+  int count = nvs.getInt("count", 0);
   savedNetworks.clear();
 
   for (int i = 0; i < count; i++)
   {
     String keySsid = "ssid" + String(i);
     String keyPass = "pass" + String(i);
-    String ssid = prefs.getString(keySsid.c_str(), "");
-    String pass = prefs.getString(keyPass.c_str(), "");
+    String ssid = nvs.getString(keySsid.c_str(), "");
+    String pass = nvs.getString(keyPass.c_str(), "");
     if (ssid.length() > 0)
-      savedNetworks.push_back({ssid, pass});
+      savedNetworks.push_back({ssid, pass, false});
   }
-  prefs.end();
 
-  Serial.printf("📋 Loaded %d saved Wi-Fi networks.\n", savedNetworks.size());
+  lastAp.ssid = nvs.getString("last_ssid", "");
+  lastAp.pass = nvs.getString("last_pass", "");
+  lastAp.channel = nvs.getUChar("last_chan", 0);
+  lastAp.valid = lastAp.ssid.length() && lastAp.channel &&
+                 nvs.getBytes("last_bssid", lastAp.bssid, sizeof(lastAp.bssid)) == sizeof(lastAp.bssid);
+  nvs.end();
+
+  String def = WIFI_SSID;
+  bool known = false;
+  for (auto &n : savedNetworks)
+    known |= n.ssid == def;
+  if (def.length() && !known)
+    savedNetworks.push_back({def, WIFI_PASSWORD, true});
+
+  LOGI("📋 Loaded %d saved Wi-Fi networks, cached AP: %s", (int)savedNetworks.size(),
+       lastAp.valid ? lastAp.ssid.c_str() : "none");
 }
 
 // =======================================================
@@ -39,19 +217,20 @@ void loadSavedNetworks()
 // =======================================================
 void saveNetwork(const String &ssid, const String &password)
 {
-  prefs.begin("wifi_networks", false);
-  int count = prefs.getInt("count", 0);
+  Preferences nvs;
+  nvs.begin("wifi_networks", false);
+  int count = nvs.getInt("count", 0);
 
   // If it already exists → update password
   for (int i = 0; i < count; i++)
   {
     String keySsid = "ssid" + String(i);
-    if (prefs.getString(keySsid.c_str(), "") == ssid)
+    if (nvs.getString(keySsid.c_str(), "") == ssid)
     {
       String keyPass = "pass" + String(i);
-      prefs.putString(keyPass.c_str(), password.c_str());
-      prefs.end();
-      Serial.println("💾 Updated existing Wi-Fi network.");
+      nvs.putString(keyPass.c_str(), password.c_str());
+      nvs.end();
+      LOGI("💾 Updated existing Wi-Fi network.");
       return;
     }
   }
@@ -59,95 +238,442 @@ void saveNetwork(const String &ssid, const String &password)
   // Add new network
   String keySsid = "ssid" + String(count);
   String keyPass = "pass" + String(count);
-  prefs.putString(keySsid.c_str(), ssid.c_str());
-  prefs.putString(keyPass.c_str(), password.c_str());
-  prefs.putInt("count", count + 1);
-  prefs.end();
+  nvs.putString(keySsid.c_str(), ssid.c_str());
+  nvs.putString(keyPass.c_str(), password.c_str());
+  nvs.putInt("count", count + 1);
+  nvs.end();
+
+  LOGI("💾 Saved new Wi-Fi network: %s", ssid.c_str());
+}
+
+// Cache the AP we are connected to; NVS is only written when it changed
+static void rememberAp(const String &ssid, const String &pass)
+{
+  const uint8_t *bssid = WiFi.BSSID();
+  uint8_t channel = WiFi.channel();
+  if (!bssid)
+    return;
+
+  if (lastAp.valid && lastAp.ssid == ssid && lastAp.pass == pass &&
+      lastAp.channel == channel && memcmp(lastAp.bssid, bssid, 6) == 0)
+    return;
+
+  lastAp.ssid = ssid;
+  lastAp.pass = pass;
+  lastAp.channel = channel;
+  memcpy(lastAp.bssid, bssid, 6);
+  lastAp.valid = true;
 
-  Serial.printf("💾 Saved new Wi-Fi network: %s\n", ssid.c_str());
+  Preferences nvs;   // Wi-Fi event task: never share the global `prefs`
+  nvs.begin("wifi_networks", false);
+  nvs.putString("last_ssid", ssid.c_str());
+  nvs.putString("last_pass", pass.c_str());
+  nvs.putBytes("last_bssid", bssid, 6);
+  nvs.putUChar("last_chan", channel);
+  nvs.end();
+  LOGI("💾 Cached AP %s (%s, ch %u)", ssid.c_str(), WiFi.BSSIDstr().c_str(), channel);
 }
 
 // =======================================================
-// 🔹 Try connecting to a specific network
+// 🔹 Rank saved networks found by the last scan (by RSSI)
 // =======================================================
-bool tryConnect(const String &ssid, const String &password)
+static std::vector<WifiCandidate> rankCandidates(int found)
+{
+  std::vector<WifiCandidate> out;
+  for (int i = 0; i < found; i++)
+  {
+    String ssid = WiFi.SSID(i);
+    for (size_t c = 0; c < savedNetworks.size(); c++)
+    {
+      if (savedNetworks[c].ssid != ssid)
+        continue;
+
+      // One entry per network: its strongest BSSID
+      auto it = std::find_if(out.begin(), out.end(), [c](const WifiCandidate &w)
+                             { return w.cred == c; });
+      if (it != out.end() && it->rssi >= WiFi.RSSI(i))
+        break;
+      if (it == out.end())
+        it = out.insert(out.end(), WifiCandidate{});
+
+      it->cred = c;
+      it->rssi = WiFi.RSSI(i);
+      it->channel = WiFi.channel(i);
+      memcpy(it->bssid, WiFi.BSSID(i), 6);
+      break;
+    }
+  }
+
+  std::sort(out.begin(), out.end(), [](const WifiCandidate &a, const WifiCandidate &b)
+            { return a.rssi > b.rssi; });
+  return out;
+}
+
+// =======================================================
+// 🔹 One blocking attempt, ended by GOT_IP or DISCONNECTED
+// =======================================================
+static bool joinAndWait(const String &ssid, const String &pass, int32_t channel,
+                        const uint8_t *bssid, uint32_t timeoutMs)
 {
-  Serial.printf("🔌 Trying Wi-Fi: %s ...\n", ssid.c_str());
-  WiFi.begin(ssid.c_str(), password.c_str());
-  unsigned long start = millis();
+  xEventGroupClearBits(wifiEvents, WIFI_BIT_GOT_IP | WIFI_BIT_FAIL);
+  WiFi.begin(ssid.c_str(), pass.c_str(), channel, bssid);
 
-  while (WiFi.status() != WL_CONNECTED && millis() - start < 10000)
+  EventBits_t bits = xEventGroupWaitBits(wifiEvents, WIFI_BIT_GOT_IP | WIFI_BIT_FAIL,
+                                         pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs));
+  if (bits & WIFI_BIT_GOT_IP)
+    return true;
+
+  LOGW("❌ %s: %s (reason %u)", ssid.c_str(), (bits & WIFI_BIT_FAIL) ? "disconnected" : "timeout", wifiLink.lastReason);
+  if (!(bits & WIFI_BIT_FAIL))
   {
-    delay(500);
-    Serial.print(".");
+    // Cancel the attempt and swallow its DISCONNECTED so it cannot fail the next one
+    WiFi.disconnect();
+    xEventGroupWaitBits(wifiEvents, WIFI_BIT_FAIL, pdTRUE, pdFALSE, pdMS_TO_TICKS(200));
   }
+  return false;
+}
+
+// =======================================================
+// 🔁 Background reconnect state machine
+// =======================================================
+static void reconnectStep();
+
+// One pending step at a time; 0 just cancels it
+static void armReconnect(uint32_t delayMs)
+{
+  clearTimer(reconnectTimer);
+  reconnectTimer = delayMs ? setTimeout(reconnectStep, delayMs) : 0;
+}
 
-  Serial.println();
-  if (WiFi.status() == WL_CONNECTED)
+static void scheduleReconnect()
+{
+  uint32_t delayMs = min<uint32_t>(1000UL << min<uint8_t>(wifiLink.failures, 6), WIFI_BACKOFF_MAX_MS);
+  wifiLink.state = LinkState::BACKOFF;
+  armReconnect(delayMs);
+  LOGD("[WIFI] Reconnect in %lu ms (failures=%u)", (unsigned long)delayMs, wifiLink.failures);
+}
+
+static void startJoin(const String &ssid, const String &pass, int32_t channel, const uint8_t *bssid)
+{
+  wifiLink.state = LinkState::REJOINING;
+  wifiLink.pendingSsid = ssid;
+  wifiLink.pendingPass = pass;
+  WiFi.begin(ssid.c_str(), pass.c_str(), channel, bssid);
+  armReconnect(WIFI_CONNECT_TIMEOUT_MS);
+}
+
+// Timer: backoff elapsed, or the attempt in flight timed out
+static void reconnectStep()
+{
+  reconnectTimer = 0;
+
+  if (wifiLink.state == LinkState::UP || wifiLink.state == LinkState::CONNECTING)
+    return;
+
+  if (wifiLink.state != LinkState::BACKOFF)
+    wifiLink.failures++;   // Attempt or scan never reported back
+
+  if (lastAp.valid && wifiLink.failures < WIFI_CACHED_RETRIES)
+  {
+    startJoin(lastAp.ssid, lastAp.pass, lastAp.channel, lastAp.bssid);
+    return;
+  }
+
+  wifiLink.state = LinkState::SCANNING;
+  wifiLink.scanMs = millis();
+  if (!scanCache.scanning)
+    startAsyncScan();
+  armReconnect(15000);
+}
+
+static void onScanDone()
+{
+  wifiLink.scanMs = millis() - wifiLink.scanMs;
+  auto candidates = rankCandidates(WiFi.scanComplete());
+  WiFi.scanDelete();
+
+  if (candidates.empty())
   {
-    Serial.printf("✅ Connected to %s\n", ssid.c_str());
-    Serial.print("📶 IP: ");
-    Serial.println(WiFi.localIP());
+    wifiLink.failures++;
+    LOGW("[WIFI] No saved network in range");
+    scheduleReconnect();
+    return;
+  }
+
+  const WifiCandidate &best = candidates.front();
+  LOGI("[WIFI] Rejoining %s (RSSI %d, ch %d)", savedNetworks[best.cred].ssid.c_str(), best.rssi, best.channel);
+  startJoin(savedNetworks[best.cred].ssid, savedNetworks[best.cred].password, best.channel, best.bssid);
+}
+
+// taskTimers: events the handler below queued, in order
+static void onLinkEvent(const LinkEvent &e)
+{
+  switch (e.event)
+  {
+  case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+    if (wifiLink.state == LinkState::CONNECTING || wifiLink.state == LinkState::UP)
+      break;   // Foreground attempts do their own bookkeeping
 
-    // Save this network as last used
-    prefs.begin("wifi_networks", false);
-    prefs.putString("last_ssid", ssid.c_str());
-    prefs.putString("last_pass", password.c_str());
-    prefs.end();
+    armReconnect(0);
+    wifiLink.state = LinkState::UP;
+    wifiLink.failures = 0;
+    wifiLink.reconnects++;
+    wifiLink.lastConnectMs = millis() - wifiLink.downSince;
+    rememberAp(wifiLink.pendingSsid, wifiLink.pendingPass);
+    LOGI("✅ Wi-Fi back on %s after %lu ms, IP %s", WiFi.SSID().c_str(),
+         (unsigned long)wifiLink.lastConnectMs, WiFi.localIP().toString().c_str());
+    break;
 
+  case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    if (wifiLink.state == LinkState::UP)
+    {
+      wifiLink.disconnects++;
+      wifiLink.downSince = millis();
+      LOGW("⚠️ Wi-Fi lost (reason %u)", e.reason);
+      scheduleReconnect();
+    }
+    else if (wifiLink.state == LinkState::REJOINING)
+    {
+      wifiLink.failures++;
+      scheduleReconnect();
+    }
+    break;
+
+  case ARDUINO_EVENT_WIFI_SCAN_DONE:
+    scanCache.scanning = false;
+    if (wifiLink.state == LinkState::SCANNING)
+      onScanDone();
+    else
+      WiFi.scanDelete();
+    break;
+
+  default:
+    break;
+  }
+}
+
+static void drainLinkEvents()
+{
+  LinkEvent e;
+  while (xQueueReceive(linkEvents, &e, 0) == pdTRUE)
+    onLinkEvent(e);
+}
+
+static void postLinkEvent(arduino_event_id_t event, uint8_t reason)
+{
+  LinkEvent e = {event, reason};
+  if (xQueueSend(linkEvents, &e, 0) == pdTRUE)
+    setTimeout(drainLinkEvents, 0);
+}
+
+// arduino_events task: wakes foreground waiters, queues the rest
+static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+  switch (event)
+  {
+  case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+    xEventGroupSetBits(wifiEvents, WIFI_BIT_GOT_IP);
+    postLinkEvent(event, 0);
+    break;
+
+  case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    wifiLink.lastReason = info.wifi_sta_disconnected.reason;   // Before the bit: joinAndWait() logs it
+    xEventGroupSetBits(wifiEvents, WIFI_BIT_FAIL);
+    postLinkEvent(event, info.wifi_sta_disconnected.reason);
+    break;
+
+  case ARDUINO_EVENT_WIFI_SCAN_DONE:
+    if (!scanCache.scanning)
+      break;   // Blocking scan at boot, handled by its caller
+    cacheScanResults(WiFi.scanComplete());
+    postLinkEvent(event, 0);
+    break;
+
+  default:
+    break;
+  }
+}
+
+// =======================================================
+// 🔹 Try connecting to a specific network (console wifi_set)
+// =======================================================
+bool tryConnect(const String &ssid, const String &password)
+{
+  LOGI("🔌 Trying Wi-Fi: %s ...", ssid.c_str());
+  wifiLink.state = LinkState::CONNECTING;
+  armReconnect(0);
+  if (WiFi.isConnected())
+  {
+    WiFi.disconnect();
+    vTaskDelay(pdMS_TO_TICKS(200));   // Let the old link's DISCONNECTED event pass
+  }
+
+  uint32_t t0 = millis();
+  if (joinAndWait(ssid, password, 0, nullptr, WIFI_CONNECT_TIMEOUT_MS))
+  {
+    wifiLink.state = LinkState::UP;
+    wifiLink.lastConnectMs = millis() - t0;
+    rememberAp(ssid, password);
+    LOGI("✅ Connected to %s, IP %s", ssid.c_str(), WiFi.localIP().toString().c_str());
     return true;
   }
 
-  Serial.println("❌ Failed to connect.");
+  LOGW("❌ Failed to connect.");
+  wifiLink.downSince = millis();
+  scheduleReconnect();
   return false;
 }
 
 // =======================================================
-// 🔹 Try connecting to all saved networks
+// 🔹 Automatic Wi-Fi initialization
 // =======================================================
-bool connectSavedNetworks()
+void initWiFi()
 {
+  LOGI("📡 Initializing Wi-Fi...");
+  uint32_t t0 = millis();
+
+  wifiEvents = xEventGroupCreate();
+  scanMutex = xSemaphoreCreateMutex();
+  linkEvents = xQueueCreate(WIFI_LINK_EVENTS, sizeof(LinkEvent));
+  WiFi.persistent(false);         // Credentials live in our own NVS namespace
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);   // Reconnects are driven by onWifiEvent()
+  WiFi.onEvent(onWifiEvent);
   loadSavedNetworks();
 
-  // First, try the last successful network
-  prefs.begin("wifi_networks", true);
-  String lastSsid = prefs.getString("last_ssid", "");
-  String lastPass = prefs.getString("last_pass", "");
-  prefs.end();
+  bool ok = false;
+  String ssid, pass;
 
-  if (lastSsid.length() > 0)
+  // 1) Last good AP, straight to its BSSID/channel (no scan)
+  if (lastAp.valid)
   {
-    Serial.printf("⭐ Trying last successful network: %s\n", lastSsid.c_str());
-    if (tryConnect(lastSsid, lastPass))
-      return true;
+    wifiLink.bootAttempts++;
+    LOGI("⭐ Joining cached AP %s (ch %u)", lastAp.ssid.c_str(), lastAp.channel);
+    ok = joinAndWait(lastAp.ssid, lastAp.pass, lastAp.channel, lastAp.bssid, WIFI_FAST_TIMEOUT_MS);
+    if (ok)
+    {
+      wifiLink.bootMethod = "cached";
+      ssid = lastAp.ssid;
+      pass = lastAp.pass;
+    }
   }
 
-  // Try all saved networks
-  for (auto &net : savedNetworks)
+  // 2) One scan, saved networks strongest-first
+  if (!ok)
   {
-    if (tryConnect(net.ssid, net.password))
-      return true;
+    uint32_t ts = millis();
+    scanCache.startedAt = ts;
+    int found = WiFi.scanNetworks(false, false, false, 120);
+    wifiLink.scanMs = millis() - ts;
+    cacheScanResults(found);
+    auto candidates = rankCandidates(found);
+    WiFi.scanDelete();
+    LOGI("🔎 Scan: %d APs, %d known, %lu ms", found, (int)candidates.size(), (unsigned long)wifiLink.scanMs);
+
+    for (auto &c : candidates)
+    {
+      const WifiCred &cred = savedNetworks[c.cred];
+      wifiLink.bootAttempts++;
+      LOGI("🔌 %s (RSSI %d, ch %d)", cred.ssid.c_str(), c.rssi, c.channel);
+      if (joinAndWait(cred.ssid, cred.password, c.channel, c.bssid, WIFI_CONNECT_TIMEOUT_MS))
+      {
+        ok = true;
+        wifiLink.bootMethod = "scan";
+        ssid = cred.ssid;
+        pass = cred.password;
+        if (cred.isDefault)
+          saveNetwork(cred.ssid, cred.password);
+        break;
+      }
+    }
   }
 
-  Serial.println("❌ No saved Wi-Fi networks available or reachable.");
-  return false;
+  wifiLink.bootMs = millis() - t0;
+  if (ok)
+  {
+    wifiLink.state = LinkState::UP;
+    rememberAp(ssid, pass);
+    LOGI("✅ Wi-Fi %s via %s in %lu ms (%u attempts), IP %s", ssid.c_str(), wifiLink.bootMethod,
+         (unsigned long)wifiLink.bootMs, wifiLink.bootAttempts, WiFi.localIP().toString().c_str());
+    return;
+  }
+
+  LOGW("⚠️ Could not connect to any network in %lu ms, retrying in background", (unsigned long)wifiLink.bootMs);
+  wifiLink.downSince = millis();
+  scheduleReconnect();
 }
 
 // =======================================================
-// 🔹 Automatic Wi-Fi initialization
+// 🔍 Scan API
 // =======================================================
-void initWiFi()
+// Starts a background scan when the cache is stale (or always
+// with force). Skipped while a connect attempt owns the radio.
+bool requestWifiScan(bool force)
 {
-  Serial.println("📡 Initializing Wi-Fi...");
-  if (connectSavedNetworks())
+  if (scanCache.scanning)
+    return false;
+  if (!force && scanCache.at && millis() - scanCache.at < WIFI_SCAN_MAX_AGE_MS)
+    return false;
+  if (wifiLink.state == LinkState::CONNECTING || wifiLink.state == LinkState::REJOINING)
+    return false;
+  return startAsyncScan();
+}
+
+void fillWifiScan(JsonDocument &doc)
+{
+  JsonObject scan = doc[F("scan")].to<JsonObject>();
+  scan[F("scanning")] = (bool)scanCache.scanning;
+  scan[F("age_ms")] = scanCache.at ? (long)(millis() - scanCache.at) : -1L;
+  scan[F("duration_ms")] = scanCache.durationMs;
+  scan[F("found")] = scanCache.found;
+
+  JsonArray networks = doc[F("available")].to<JsonArray>();
+  if (!scanMutex || xSemaphoreTake(scanMutex, pdMS_TO_TICKS(50)) != pdTRUE)
     return;
 
-  Serial.println("📶 Trying default credentials...");
-  if (tryConnect(WIFI_SSID, WIFI_PASSWORD))
+  char bssid[18];
+  for (uint8_t i = 0; i < scanCache.count; i++)
   {
-    saveNetwork(WIFI_SSID, WIFI_PASSWORD);
-    return;
+    const ScanEntry &e = scanCache.entries[i];
+    snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
+             e.bssid[0], e.bssid[1], e.bssid[2], e.bssid[3], e.bssid[4], e.bssid[5]);
+
+    JsonObject net = networks.add<JsonObject>();
+    net[F("ssid")] = e.ssid;
+    net[F("rssi")] = e.rssi;
+    net[F("bssid")] = bssid;
+    net[F("channel")] = e.channel;
+    net[F("encryption")] = e.encryption;
+    net[F("hidden")] = e.ssid[0] == 0;
   }
+  xSemaphoreGive(scanMutex);
+}
 
-  Serial.println("⚠️ Could not connect to any network!");
+// =======================================================
+// 📊 Time-to-connect metrics (/wifi_info "connect", wifi_stats)
+// =======================================================
+void fillWifiMetrics(JsonObject o)
+{
+  static const char *states[] = {"connecting", "up", "backoff", "rejoining", "scanning"};
+
+  o[F("state")] = states[(uint8_t)wifiLink.state];
+  o[F("boot_ms")] = wifiLink.bootMs;
+  o[F("boot_method")] = wifiLink.bootMethod;
+  o[F("boot_attempts")] = wifiLink.bootAttempts;
+  o[F("scan_ms")] = wifiLink.scanMs;
+  o[F("last_reconnect_ms")] = wifiLink.lastConnectMs;
+  o[F("reconnects")] = wifiLink.reconnects;
+  o[F("disconnects")] = wifiLink.disconnects;
+  o[F("last_reason")] = wifiLink.lastReason;
+  o[F("cached_ap")] = lastAp.valid ? lastAp.ssid : String();
+  o[F("cached_channel")] = lastAp.channel;
+}
+
+String wifiStatsReport()
+{
+  JsonDocument doc;
+  fillWifiMetrics(doc.to<JsonObject>());
+  String out;
+  serializeJsonPretty(doc, out);
+  return out;
 }
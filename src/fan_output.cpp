@@ -0,0 +1,276 @@
+#include <Arduino.h>
+#include "driver/ledc.h"
+#include "esp_idf_version.h"
+#include "project_config.h"
+
+// ============================================================
+// 🌀 Fan PWM output
+// ------------------------------------------------------------
+// Every duty change of a zone's output goes through
+// fanOutputSet(zone, duty):
+//
+// - Slew rate: the duty moves toward its target by at most
+//   fan_slew_pct_per_s, and each step is handed to the LEDC
+//   fade engine, which ramps the compare value in hardware.
+//   No CPU time is spent stepping and the fan never jumps.
+// - Start boost: spinning up from 0 first drives
+//   fan_start_boost_pct for fan_start_boost_ms so the rotor
+//   breaks away, then ramps to the target.
+// - Unchanged duties are not written again.
+//
+// The fade API blocks until the running fade ends, and that
+// must never happen under fanMutex:
+// - every fade ends before the next control tick (it gets at
+//   most FAN_FADE_SHARE of the interval, minus the time already
+//   spent since the tick, so off-tick steps get less);
+// - a step that arrives while a fade still runs is deferred and
+//   applied by fanOutputPoll() once the fade is over;
+// - fanOutputStop() cuts a running fade instead of waiting for
+//   it (ledc_fade_stop on IDF 5, ledc_stop before that).
+//
+// Each zone drives its own LEDC channel, handed over by
+// fanOutputInit() when fan_zones.cpp sets it up; slew and boost
+// settings are shared.
+// ============================================================
+#define FAN_FADE_SHARE 0.9f   // Part of the interval a step may fade over
+
+static uint8_t channel[FAN_ZONES_MAX];      // Arduino LEDC channel of each zone
+static int current[FAN_ZONES_MAX];          // Duty last programmed (fade target)
+static int pending[FAN_ZONES_MAX];          // Target requested during the boost
+static uint32_t lastStepMs[FAN_ZONES_MAX];
+static uint32_t boostUntil[FAN_ZONES_MAX];  // 0 = no boost running
+static uint32_t fadeEnd[FAN_ZONES_MAX];     // millis() when the running fade is over
+static bool fading[FAN_ZONES_MAX];
+static bool deferred[FAN_ZONES_MAX];        // pending[] waits for the fade to end
+static bool outputCut[FAN_ZONES_MAX];       // ledc_stop()ped, duty register stale
+static uint32_t tickMs = 0;                 // Start of the current control tick
+static bool fadeReady = false;
+static SemaphoreHandle_t fanMutex = nullptr;
+
+struct FanLock
+{
+  FanLock() { xSemaphoreTake(fanMutex, portMAX_DELAY); }
+  ~FanLock() { xSemaphoreGive(fanMutex); }
+};
+
+// Arduino channel -> IDF speed mode / channel (same split as ledcWrite)
+static uint8_t channelOf(int z) { return channel[z]; }
+static ledc_mode_t ledcMode(int z) { return (ledc_mode_t)(channelOf(z) / 8); }
+static ledc_channel_t ledcChannel(int z) { return (ledc_channel_t)(channelOf(z) % 8); }
+
+static bool fadeBusy(int z, uint32_t now)
+{
+  return fading[z] && (int32_t)(now - fadeEnd[z]) < 0;
+}
+
+// Only called with no fade running, so the LEDC calls never wait
+static void writeNow(int z, int duty)
+{
+  if (fadeReady)
+    ledc_set_duty_and_update(ledcMode(z), ledcChannel(z), duty, 0);
+  else
+    ledcWrite(channelOf(z), duty);
+  current[z] = duty;
+  fading[z] = false;
+}
+
+static void fadeTo(int z, int duty, uint32_t ms, uint32_t now)
+{
+  if (!fadeReady || ms == 0)
+  {
+    writeNow(z, duty);
+    return;
+  }
+  ledc_set_fade_time_and_start(ledcMode(z), ledcChannel(z), duty, ms, LEDC_FADE_NO_WAIT);
+  current[z] = duty;
+  fading[z] = true;
+  fadeEnd[z] = now + ms + 2;   // Fade end interrupt lands on a PWM period
+}
+
+// Output to 0 now, even mid-fade
+static void cutOutput(int z)
+{
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  ledc_fade_stop(ledcMode(z), ledcChannel(z));
+  writeNow(z, 0);
+#else
+  // No fade stop before IDF 5: force the pin low; the fade runs
+  // out unseen and the next step rewrites the duty
+  ledc_stop(ledcMode(z), ledcChannel(z), 0);
+  current[z] = 0;
+  outputCut[z] = true;
+#endif
+}
+
+// Time a fade started now may take and still end before the next tick
+static uint32_t fadeBudget(uint32_t now)
+{
+  uint32_t end = tickMs + (uint32_t)(g_settings.fan_control_interval * FAN_FADE_SHARE);
+  return (int32_t)(end - now) > 0 ? end - now : 0;
+}
+
+static bool validZone(int z)
+{
+  return fanMutex && z >= 0 && z < FAN_ZONES_MAX;
+}
+
+// Call after the zone's LEDC channel is (re)configured; duty is 0 then
+void fanOutputInit(int z, uint8_t ch)
+{
+  if (z < 0 || z >= FAN_ZONES_MAX)
+    return;
+  if (!fanMutex)
+    fanMutex = xSemaphoreCreateMutex();
+  if (!fadeReady)
+  {
+    esp_err_t err = ledc_fade_func_install(0);
+    fadeReady = err == ESP_OK || err == ESP_ERR_INVALID_STATE;   // Already installed
+    if (!fadeReady)
+      LOGW("[FAN] LEDC fade unavailable (%d), stepping duty", err);
+  }
+
+  FanLock lock;
+  channel[z] = ch;
+  current[z] = pending[z] = 0;
+  boostUntil[z] = 0;
+  fading[z] = deferred[z] = outputCut[z] = false;
+  lastStepMs[z] = millis();
+}
+
+// One step of zone z toward `target`; returns the duty now programmed
+static int step(int z, int target, uint32_t now)
+{
+  int maxv = pwm_max();
+  target = constrain(target, 0, maxv);
+
+  if (fadeBusy(z, now))
+  {
+    pending[z] = target;
+    deferred[z] = true;
+    return current[z];
+  }
+  deferred[z] = false;
+  if (outputCut[z])
+  {
+    outputCut[z] = false;
+    writeNow(z, 0);   // Re-enables the output at a known duty
+  }
+
+  if (boostUntil[z])
+  {
+    if (target == 0)
+      boostUntil[z] = 0;   // Stop request cancels the kick
+    else if ((int32_t)(now - boostUntil[z]) < 0)
+    {
+      pending[z] = target;
+      return current[z];
+    }
+    else
+    {
+      boostUntil[z] = 0;
+      lastStepMs[z] = now;
+    }
+  }
+
+  if (target > 0 && current[z] == 0 && g_settings.fan_start_boost_ms > 0)
+  {
+    int kick = max(target, maxv * g_settings.fan_start_boost_pct / 100);
+    writeNow(z, kick);
+    pending[z] = target;
+    boostUntil[z] = (now + g_settings.fan_start_boost_ms) | 1;
+    lastStepMs[z] = now;
+    return current[z];
+  }
+
+  uint32_t dt = now - lastStepMs[z];
+  int delta = target - current[z];
+  if (delta == 0)
+  {
+    lastStepMs[z] = now;
+    return current[z];
+  }
+
+  uint16_t slew = g_settings.fan_slew_pct_per_s;
+  if (!slew)
+  {
+    writeNow(z, target);
+    lastStepMs[z] = now;
+    return current[z];
+  }
+
+  // Largest move allowed since the last step, at least one count
+  int allowed = max(1, (int)((uint64_t)maxv * slew * dt / 100000));
+  int move = constrain(delta, -allowed, allowed);
+  uint32_t ms = (uint32_t)((uint64_t)abs(move) * 100000 / ((uint64_t)maxv * slew));
+  fadeTo(z, current[z] + move, min(ms, fadeBudget(now)), now);
+  lastStepMs[z] = now;
+  return current[z];
+}
+
+int fanOutputSet(int z, int target)
+{
+  if (!validZone(z))
+    return 0;
+  FanLock lock;
+  return step(z, target, millis());
+}
+
+// Start of a control tick: fades started from now on end before the next one
+void fanOutputTick()
+{
+  tickMs = millis();
+}
+
+// Ends running boosts on time and applies steps that had to
+// wait for a fade; cheap, call every loop pass
+void fanOutputPoll()
+{
+  if (!fanMutex)
+    return;
+  FanLock lock;
+  uint32_t now = millis();
+  for (int z = 0; z < FAN_ZONES_MAX; z++)
+  {
+    if (boostUntil[z] && (int32_t)(now - boostUntil[z]) >= 0)
+      step(z, pending[z], now);
+    else if (deferred[z] && !fadeBusy(z, now))
+      step(z, pending[z], now);
+  }
+}
+
+// Immediate stop (safety cut), no ramp
+void fanOutputStop(int z)
+{
+  if (!validZone(z))
+    return;
+  FanLock lock;
+  boostUntil[z] = 0;
+  pending[z] = 0;
+  deferred[z] = false;
+  if (fadeBusy(z, millis()))
+    cutOutput(z);
+  else if (current[z])
+    writeNow(z, 0);
+}
+
+// No fade running: the zone's channel may be reconfigured
+bool fanOutputIdle(int z)
+{
+  if (!validZone(z))
+    return true;
+  FanLock lock;
+  return !fadeBusy(z, millis());
+}
+
+int fanOutputDuty(int z)
+{
+  return z >= 0 && z < FAN_ZONES_MAX ? current[z] : 0;
+}
+
+bool fanOutputBoosting(int z)
+{
+  return z >= 0 && z < FAN_ZONES_MAX && boostUntil[z] != 0;
+}
+
+static MetricGauge mFanOutput("fan_pwm_output", "Duty programmed into LEDC for zone 0 (ramp target of the running fade)",
+                              []() -> float { return current[0]; });
@@ -0,0 +1,167 @@
+#include <Arduino.h>
+#include "driver/pcnt.h"
+#include "project_config.h"
+#include "fan_tach.h"
+
+// ============================================================
+// 🧭 Fan tachometer (PCNT) and closed-loop RPM
+// ------------------------------------------------------------
+// The tach line of the zone 0 fan (4-wire, open collector,
+// pulled up) is counted by PCNT unit 0 on rising edges, behind
+// the glitch filter. No interrupt is attached: taskControl reads
+// the counter every loop pass (20 ms) and feeds TachMeter.
+//
+// With fan_closed_loop set, the AUTO/MANUAL output (0..100%)
+// is read as a share of fan_max_rpm and RpmController picks
+// the duty that holds that speed.
+//
+// A stall (driven, no pulses for fan_stall_ms) cuts the output
+// so the next step kicks the fan again with the start boost.
+//
+// Build with -D FAN_TACH_SIM=1 to replace PCNT with SimFan,
+// driven by the duty actually programmed: the whole loop then
+// runs without a fan attached.
+// ============================================================
+#ifndef FAN_TACH_SIM
+#define FAN_TACH_SIM 0
+#endif
+#define TACH_PCNT_UNIT PCNT_UNIT_0
+#define TACH_PCNT_LIMIT 32767
+#define TACH_FILTER_APB 1023   // Ignore pulses shorter than ~12.8 µs
+
+static TachMeter tach;
+static RpmController rpmLoop;
+static bool tachReady = false;
+static uint32_t tachTotal = 0;
+static int16_t tachLast = 0;
+static uint32_t lastUpdateMs = 0;
+
+#if FAN_TACH_SIM
+static SimFan simFan;
+#endif
+
+void fanTachInit()
+{
+  const SystemSettings &s = g_settings;
+  tach.configure(s.fan_tach_ppr, s.fan_rpm_window_ms, s.fan_stall_ms);
+  rpmLoop.maxRpm = s.fan_max_rpm;
+  rpmLoop.reset();
+  lastUpdateMs = millis();
+
+  if (!s.fan_tach_enabled || tachReady)
+    return;
+
+#if FAN_TACH_SIM
+  simFan.maxRpm = s.fan_max_rpm;
+  simFan.pulsesPerRev = s.fan_tach_ppr;
+  tachReady = true;
+  LOGI("[TACH] simulated fan (%u RPM max)", (unsigned)s.fan_max_rpm);
+#else
+  pcnt_config_t cfg = {};
+  cfg.pulse_gpio_num = fan_tach_pin;
+  cfg.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+  cfg.channel = PCNT_CHANNEL_0;
+  cfg.unit = TACH_PCNT_UNIT;
+  cfg.pos_mode = PCNT_COUNT_INC;
+  cfg.neg_mode = PCNT_COUNT_DIS;
+  cfg.lctrl_mode = PCNT_MODE_KEEP;
+  cfg.hctrl_mode = PCNT_MODE_KEEP;
+  cfg.counter_h_lim = TACH_PCNT_LIMIT;
+  cfg.counter_l_lim = 0;
+
+  if (pcnt_unit_config(&cfg) != ESP_OK)
+  {
+    LOGE("[TACH] PCNT config failed on GPIO%d", fan_tach_pin);
+    return;
+  }
+  gpio_set_pull_mode((gpio_num_t)fan_tach_pin, GPIO_PULLUP_ONLY);
+  pcnt_set_filter_value(TACH_PCNT_UNIT, TACH_FILTER_APB);
+  pcnt_filter_enable(TACH_PCNT_UNIT);
+  pcnt_counter_pause(TACH_PCNT_UNIT);
+  pcnt_counter_clear(TACH_PCNT_UNIT);
+  pcnt_counter_resume(TACH_PCNT_UNIT);
+  tachLast = 0;
+  tachReady = true;
+  LOGI("[TACH] PCNT on GPIO%d, %u pulses/rev", fan_tach_pin, (unsigned)s.fan_tach_ppr);
+#endif
+}
+
+// Cumulative pulses; the counter wraps to 0 at TACH_PCNT_LIMIT
+static uint32_t readPulses(uint32_t dtMs)
+{
+#if FAN_TACH_SIM
+  simFan.step(fanOutputDuty(0) * 100.0f / pwm_max(), dtMs / 1000.0f);
+  return simFan.pulses();
+#else
+  int16_t v = 0;
+  pcnt_get_counter_value(TACH_PCNT_UNIT, &v);
+  int32_t d = (int32_t)v - tachLast;
+  if (d < 0)
+    d += TACH_PCNT_LIMIT;
+  tachLast = v;
+  tachTotal += d;
+  return tachTotal;
+#endif
+}
+
+// Every loop pass of taskControl
+void fanTachUpdate()
+{
+  if (!tachReady || !g_settings.fan_tach_enabled)
+    return;
+
+  uint32_t now = millis();
+  uint32_t pulses = readPulses(now - lastUpdateMs);
+  lastUpdateMs = now;
+
+  bool wasStalled = tach.stalled();
+  tach.sample(now, pulses, fanOutputDuty(0) > 0 && !fanOutputBoosting(0));
+  if (tach.stalled() && !wasStalled)
+  {
+    LOGW("[TACH] fan stalled at duty %d/%d, restarting", fanOutputDuty(0), pwm_max());
+    rpmLoop.reset();
+    fanOutputStop(0);   // Next step starts from 0 with the boost
+  }
+}
+
+// Duty for the control output `percent` (0..100), open or closed loop
+int fanTachDuty(float percent, float dtS)
+{
+  int maxv = pwm_max();
+  if (!g_settings.fan_closed_loop || !tachReady || !g_settings.fan_tach_enabled)
+    return lroundf(percent / 100.0f * maxv);
+
+  float targetRpm = percent / 100.0f * g_settings.fan_max_rpm;
+  float duty = rpmLoop.update(targetRpm, tach.rpm(), dtS);
+  return lroundf(duty / 100.0f * maxv);
+}
+
+float fanTachRpm()
+{
+  return tachReady ? tach.rpm() : NAN;
+}
+
+uint32_t fanTachStalls()
+{
+  return tach.stalls();
+}
+
+void fillTach(JsonObject o)
+{
+  o[F("enabled")] = g_settings.fan_tach_enabled && tachReady;
+  o[F("simulated")] = (bool)FAN_TACH_SIM;
+  o[F("rpm")] = tachReady ? lroundf(tach.rpm()) : 0;
+  o[F("stalled")] = tach.stalled();
+  o[F("stalls")] = tach.stalls();
+  o[F("closed_loop")] = g_settings.fan_closed_loop;
+  if (g_settings.fan_closed_loop)
+  {
+    o[F("target_rpm")] = lroundf(sensorData.targetPercent / 100.0f * g_settings.fan_max_rpm);
+    o[F("integral")] = rpmLoop.integral();
+  }
+}
+
+static MetricGauge mFanRpm("fan_rpm", "Fan speed from the tach input, NaN without tach",
+                           []() -> float { return fanTachRpm(); });
+static MetricCounter mFanStalls("fan_stalls", "Driven fan stopped producing tach pulses",
+                                []() -> uint32_t { return tach.stalls(); });
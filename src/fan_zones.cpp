@@ -0,0 +1,454 @@
+#include <Arduino.h>
+#include "driver/ledc.h"
+#include "project_config.h"
+
+// ============================================================
+// 🌪 Fan zones
+// ------------------------------------------------------------
+// Up to FAN_ZONES_MAX PWM outputs (radiator, intercooler,
+// cabin, ...), each bound to a sensor with its own curve,
+// limits and AUTO/MANUAL mode.
+//
+// AUTO reads the zone's multi-point curve (fan_curve.h), or the
+// temp_min -> temp_max ramp when it has none, at the temperature
+// tracked through the hysteresis band, then applies the limits
+// and the on/off dwell. The temperature is tempControl(): the
+// sensor estimate, temp_predict_s ahead. Without a usable
+// reading (NaN) a zone holds its output, and after
+// temp_stale_ms runs at fan_failsafe_pct until readings return.
+//
+// Zone 0 is the original fan: its pin, channel, curve, mode and
+// manual state live in the top-level settings (so /toggle_fan,
+// /set_mode and the console keep working). The control loop
+// reads zone 0 through zoneView(), a local copy with those
+// fields overlaid; syncPrimaryZone() only updates the stored
+// copy when settings are loaded. The tach / RPM loop only
+// drives zone 0.
+//
+// Each control tick compiles the settings into the bank below
+// (one array per field) and walks it once: sensor -> percent ->
+// duty -> fan_output. All zones share the PWM frequency,
+// resolution, slew rate and start boost.
+//
+// taskControl is the only writer of the bank and the only task
+// that (re)configures the LEDC channels: fanZonesInitPwm() just
+// flags the change, and the next tick rebuilds the channels
+// once every running fade is over. g_settings is read, never
+// written, from here.
+// ============================================================
+struct ZoneBank
+{
+  uint8_t count;
+
+  // Config, rebuilt from g_settings every tick
+  bool active[FAN_ZONES_MAX];
+  ZoneSensor sensor[FAN_ZONES_MAX];
+  FanCurve curve[FAN_ZONES_MAX];     // count < 2: linear ramp below
+  float tMin[FAN_ZONES_MAX];
+  float invSpan[FAN_ZONES_MAX];      // 1 / (temp_max - temp_min)
+  float minPct[FAN_ZONES_MAX];
+  float maxPct[FAN_ZONES_MAX];
+  float manualPct[FAN_ZONES_MAX];    // < 0 = AUTO
+
+  // State of the last tick
+  CurveFollower follow[FAN_ZONES_MAX];
+  float tempC[FAN_ZONES_MAX];        // Control temperature, NaN = none
+  uint32_t lostSinceMs[FAN_ZONES_MAX];   // 0 = reading available
+  bool failsafe[FAN_ZONES_MAX];
+  float percent[FAN_ZONES_MAX];
+  int duty[FAN_ZONES_MAX];
+};
+
+static ZoneBank bank = {};
+static bool pwmReady[FAN_ZONES_MAX] = {};
+static bool attached[FAN_ZONES_MAX] = {};
+static int8_t attachedPin[FAN_ZONES_MAX];
+static volatile bool pwmDirty = false;   // Channels wait for a rebuild
+
+// Zone i as the control loop sees it (zone 0 with the top-level fields)
+static FanZoneSettings zoneView(const SystemSettings &s, int i)
+{
+  FanZoneSettings z = s.zones[i];
+  if (i == 0)
+  {
+    z.enabled = true;
+    z.pwm_pin = fan_control_pin;
+    z.pwm_channel = s.pwm_channel;
+    z.temp_min = s.min_rotation_temp;
+    z.temp_max = s.max_rotation_temp;
+    z.mode = s.fan_mode;
+    z.manual_percent = s.manual_percent;
+    z.manual_on = s.manual_on;
+  }
+  return z;
+}
+
+void syncPrimaryZone(SystemSettings &s)
+{
+  s.zones[0] = zoneView(s, 0);
+  s.zone_count = constrain(s.zone_count, 1, FAN_ZONES_MAX);
+}
+
+static const char *sensorName(ZoneSensor v)
+{
+  return v == ZoneSensor::SYSTEM ? "system" : "engine";
+}
+
+static void zoneLabel(const FanZoneSettings &z, int i, char *out, size_t n)
+{
+  if (z.name[0])
+    snprintf(out, n, "%s", z.name);
+  else
+    snprintf(out, n, "zone%d", i);
+}
+
+// ============================================================
+// 🔌 LEDC channels
+// ============================================================
+// Stops every zone, then rebuilds the channels once no fade is
+// running; false = try again on the next tick. Runs in
+// taskControl, or in setup() before that task exists.
+static bool rebuildPwm(const SystemSettings &s)
+{
+  bool idle = true;
+  for (int i = 0; i < FAN_ZONES_MAX; i++)
+  {
+    pwmReady[i] = false;
+    if (attached[i])
+    {
+      fanOutputStop(i);
+      idle = fanOutputIdle(i) && idle;
+    }
+  }
+  if (!idle)
+    return false;
+
+  int count = constrain(s.zone_count, 1, FAN_ZONES_MAX);
+  for (int i = 0; i < FAN_ZONES_MAX; i++)
+  {
+    if (attached[i])
+    {
+      ledcDetachPin(attachedPin[i]);
+      attached[i] = false;
+    }
+
+    FanZoneSettings z = zoneView(s, i);
+    if (i >= count || !z.enabled)
+      continue;
+    if (z.pwm_pin < 0 || z.pwm_channel >= SOC_LEDC_CHANNEL_NUM)
+    {
+      LOGW("[ZONE] %d: no pin or channel %u out of range, disabled", i, z.pwm_channel);
+      continue;
+    }
+
+    bool clash = false;
+    for (int k = 0; k < i && !clash; k++)
+    {
+      FanZoneSettings o = zoneView(s, k);
+      clash = pwmReady[k] && (o.pwm_channel == z.pwm_channel || o.pwm_pin == z.pwm_pin);
+    }
+    if (clash)
+    {
+      LOGW("[ZONE] %d: pin %d / channel %u already in use, disabled", i, z.pwm_pin, z.pwm_channel);
+      continue;
+    }
+
+    ledcSetup(z.pwm_channel, s.pwm_freq_hz, s.pwm_resolution_bits);
+    ledcAttachPin(z.pwm_pin, z.pwm_channel);
+    ledcWrite(z.pwm_channel, 0);
+    fanOutputInit(i, z.pwm_channel);
+    attached[i] = true;
+    attachedPin[i] = z.pwm_pin;
+    pwmReady[i] = true;
+    LOGI("[ZONE] %d: GPIO%d on channel %u", i, z.pwm_pin, z.pwm_channel);
+  }
+  return true;
+}
+
+// PWM settings changed (settingsApply -> reinitPwm)
+void fanZonesInitPwm()
+{
+  if (!hControl)
+    rebuildPwm(g_settings);   // Boot: nothing is driving the fans yet
+  else
+    pwmDirty = true;
+}
+
+// ============================================================
+// 🔁 Control tick (taskControl, every fan_control_interval)
+// ============================================================
+static void compile(const SystemSettings &s)
+{
+  bank.count = constrain(s.zone_count, 1, FAN_ZONES_MAX);
+  for (int i = 0; i < bank.count; i++)
+  {
+    FanZoneSettings z = zoneView(s, i);
+    bank.active[i] = z.enabled && pwmReady[i];
+    bank.sensor[i] = z.sensor;
+    bank.curve[i] = z.curve;
+    bank.tMin[i] = z.temp_min;
+    bank.invSpan[i] = 1.0f / max((float)(z.temp_max - z.temp_min), 0.1f);
+    bank.minPct[i] = z.min_percent;
+    bank.maxPct[i] = max(z.max_percent, z.min_percent);
+    bank.manualPct[i] = z.mode == FanMode::MANUAL ? (z.manual_on ? z.manual_percent : 0) : -1;
+
+    CurveFollower &f = bank.follow[i];
+    f.hystRise = z.hyst_rise;
+    f.hystFall = z.hyst_fall;
+    f.minOnMs = z.min_on_ms;
+    f.minOffMs = z.min_off_ms;
+  }
+}
+
+void fanZonesTick(const SystemInfo &in, float dtS)
+{
+  fanOutputTick();
+  if (pwmDirty)
+  {
+    pwmDirty = false;
+    if (!rebuildPwm(g_settings))
+      pwmDirty = true;
+  }
+  compile(g_settings);
+
+  bool cut = in.systemC > g_settings.system_temp_alert;
+  int n = bank.count;
+  int maxv = pwm_max();
+  uint32_t now = millis();
+
+  for (int i = 0; i < n; i++)
+  {
+    bank.tempC[i] = tempControl(in, bank.sensor[i]);
+    if (!isnan(bank.tempC[i]))
+      bank.lostSinceMs[i] = 0;
+    else if (!bank.lostSinceMs[i])
+      bank.lostSinceMs[i] = now | 1;
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    CurveFollower &f = bank.follow[i];
+    bool autoMode = !cut && bank.active[i] && bank.manualPct[i] < 0;
+    bool lost = bank.lostSinceMs[i] && now - bank.lostSinceMs[i] >= g_settings.temp_stale_ms;
+    if (autoMode && lost != bank.failsafe[i])
+    {
+      if (lost)
+        LOGW("[ZONE] %d: no temperature for %u ms, failsafe %u%%", i, (unsigned)g_settings.temp_stale_ms, (unsigned)g_settings.fan_failsafe_pct);
+      else
+        LOGI("[ZONE] %d: temperature back", i);
+      bank.failsafe[i] = lost;
+    }
+
+    float p;
+    if (!autoMode)
+    {
+      f.reset();   // Hysteresis and dwell restart from the next AUTO reading
+      p = cut || !bank.active[i] ? 0 : bank.manualPct[i];
+    }
+    else if (lost)
+      p = g_settings.fan_failsafe_pct;
+    else if (isnan(bank.tempC[i]))
+      p = bank.percent[i];   // Dropout: hold until it is declared lost
+    else
+    {
+      float t = f.track(bank.tempC[i]);
+      if (bank.curve[i].valid())
+        p = bank.curve[i].eval(t);
+      else
+        p = constrain((t - bank.tMin[i]) * bank.invSpan[i], 0.0f, 1.0f) * 100.0f;
+    }
+    if (p > 0)
+      p = constrain(p, bank.minPct[i], bank.maxPct[i]);
+    if (autoMode && !lost)
+      p = f.dwell(p, now);
+    bank.percent[i] = p;
+  }
+
+  // Zone 0 goes through the tach (duty, or RPM loop output)
+  bank.duty[0] = fanTachDuty(bank.percent[0], dtS);
+  for (int i = 1; i < n; i++)
+    bank.duty[i] = lroundf(bank.percent[i] / 100.0f * maxv);
+
+  // Ramp toward the new duties (hardware fade); a safety cut is immediate
+  for (int i = 0; i < n; i++)
+  {
+    if (!bank.active[i])
+      continue;
+    if (cut)
+      fanOutputStop(i);
+    else
+      fanOutputSet(i, bank.duty[i]);
+  }
+
+  sensorData.targetPercent = lroundf(bank.percent[0]);
+  sensorData.target_pwm = bank.duty[0];
+}
+
+// ============================================================
+// 💾 Settings JSON ("zones" array)
+// ============================================================
+void fillZoneSettings(const SystemSettings &s, JsonArray arr)
+{
+  for (int i = 0; i < s.zone_count; i++)
+  {
+    FanZoneSettings z = zoneView(s, i);
+    JsonObject o = arr.add<JsonObject>();
+    o["name"] = z.name;
+    o["enabled"] = z.enabled;
+    o["pwm_pin"] = z.pwm_pin;
+    o["pwm_channel"] = z.pwm_channel;
+    o["sensor"] = sensorName(z.sensor);
+    o["temp_min"] = z.temp_min;
+    o["temp_max"] = z.temp_max;
+    JsonArray curve = o["curve"].to<JsonArray>();
+    for (uint8_t k = 0; k < z.curve.count; k++)
+    {
+      JsonArray pt = curve.add<JsonArray>();
+      pt.add(z.curve.pts[k].tempC);
+      pt.add(z.curve.pts[k].percent);
+    }
+    o["hyst_rise"] = z.hyst_rise;
+    o["hyst_fall"] = z.hyst_fall;
+    o["min_on_ms"] = z.min_on_ms;
+    o["min_off_ms"] = z.min_off_ms;
+    o["min_percent"] = z.min_percent;
+    o["max_percent"] = z.max_percent;
+    o["mode"] = z.mode == FanMode::MANUAL ? "MANUAL" : "AUTO";
+    o["manual_percent"] = z.manual_percent;
+    o["manual_on"] = z.manual_on;
+  }
+}
+
+// Zone 0 only takes name, sensor, curve, hysteresis, dwell and
+// limits from here; the rest comes from the top-level fields.
+// A curve is given as [[temp, percent], ...], in any order.
+void zonesFromJson(SystemSettings &s, JsonArrayConst arr)
+{
+  s.zone_count = constrain((int)arr.size(), 1, FAN_ZONES_MAX);
+  for (int i = 0; i < s.zone_count; i++)
+  {
+    JsonObjectConst o = arr[i];
+    FanZoneSettings &z = s.zones[i];
+
+    if (o["name"].is<const char *>())
+      strlcpy(z.name, o["name"], sizeof(z.name));
+    if (o["sensor"].is<const char *>())
+      z.sensor = strcasecmp(o["sensor"], "system") == 0 ? ZoneSensor::SYSTEM : ZoneSensor::ENGINE;
+    z.min_percent = min<int>(o["min_percent"] | z.min_percent, 100);
+    z.max_percent = min<int>(o["max_percent"] | z.max_percent, 100);
+    if (o["curve"].is<JsonArrayConst>())
+    {
+      FanCurve c;
+      for (JsonVariantConst pt : o["curve"].as<JsonArrayConst>())
+      {
+        if (c.count == FAN_CURVE_POINTS)
+          break;
+        c.pts[c.count++] = {(int16_t)(pt[0] | 0), (uint8_t)min<int>(pt[1] | 0, 100)};
+      }
+      c.normalize();
+      z.curve = c;
+    }
+    z.hyst_rise = max(o["hyst_rise"] | z.hyst_rise, 0.0f);
+    z.hyst_fall = max(o["hyst_fall"] | z.hyst_fall, 0.0f);
+    z.min_on_ms = o["min_on_ms"] | z.min_on_ms;
+    z.min_off_ms = o["min_off_ms"] | z.min_off_ms;
+    if (i == 0)
+      continue;
+
+    z.enabled = o["enabled"] | z.enabled;
+    z.pwm_pin = o["pwm_pin"] | z.pwm_pin;
+    z.pwm_channel = o["pwm_channel"] | z.pwm_channel;
+    z.temp_min = o["temp_min"] | z.temp_min;
+    z.temp_max = o["temp_max"] | z.temp_max;
+    if (o["mode"].is<const char *>())
+      z.mode = strcasecmp(o["mode"], "MANUAL") == 0 ? FanMode::MANUAL : FanMode::AUTO;
+    z.manual_percent = min<int>(o["manual_percent"] | z.manual_percent, 100);
+    z.manual_on = o["manual_on"] | z.manual_on;
+  }
+}
+
+// ============================================================
+// 📤 /api/zones
+// ============================================================
+void fillZones(JsonDocument &doc)
+{
+  const SystemSettings &s = g_settings;
+  doc[F("count")] = s.zone_count;
+  doc[F("max")] = FAN_ZONES_MAX;
+  JsonArray arr = doc[F("zones")].to<JsonArray>();
+  fillZoneSettings(s, arr);
+
+  for (int i = 0; i < s.zone_count; i++)
+  {
+    JsonObject st = arr[i][F("state")].to<JsonObject>();
+    st[F("active")] = i < bank.count && bank.active[i];
+    st[F("temp")] = bank.tempC[i];
+    st[F("tracked")] = bank.follow[i].tracked();
+    st[F("failsafe")] = bank.failsafe[i];
+    st[F("percent")] = bank.percent[i];
+    st[F("duty")] = fanOutputDuty(i);
+    st[F("boosting")] = fanOutputBoosting(i);
+  }
+}
+
+// ============================================================
+// 🖥️ Console `zones`
+// ============================================================
+String fanZonesReport()
+{
+  String out = "=== fan zones (" + String(g_settings.zone_count) + "/" + String(FAN_ZONES_MAX) + ") ===\n";
+  char line[128], name[20];
+  for (int i = 0; i < g_settings.zone_count; i++)
+  {
+    FanZoneSettings z = zoneView(g_settings, i);
+    zoneLabel(z, i, name, sizeof(name));
+    snprintf(line, sizeof(line), "%d %-12s %s GPIO%-3d ch%-2u %-6s %3d..%3d C %3u..%3u%% %-6s -> %5.1f%% duty=%d%s\n",
+             i, name, i < bank.count && bank.active[i] ? "on " : "off", z.pwm_pin, z.pwm_channel,
+             sensorName(z.sensor), z.temp_min, z.temp_max, z.min_percent, z.max_percent,
+             z.mode == FanMode::MANUAL ? "MANUAL" : "AUTO", bank.percent[i], fanOutputDuty(i),
+             fanOutputBoosting(i) ? " (boost)" : "");
+    out += line;
+    if (z.curve.valid())
+    {
+      out += "  curve";
+      for (uint8_t k = 0; k < z.curve.count; k++)
+      {
+        snprintf(line, sizeof(line), " %d:%u", z.curve.pts[k].tempC, z.curve.pts[k].percent);
+        out += line;
+      }
+      out += "\n";
+    }
+    snprintf(line, sizeof(line), "  hysteresis +%.1f/-%.1f C, on >= %lu ms, off >= %lu ms\n",
+             z.hyst_rise, z.hyst_fall, (unsigned long)z.min_on_ms, (unsigned long)z.min_off_ms);
+    out += line;
+  }
+  return out;
+}
+
+// ============================================================
+// 📊 Metrics
+// ============================================================
+static bool collectZonePercent(int i, char *labels, size_t n, float &value)
+{
+  if (i >= bank.count)
+    return false;
+  char name[20];
+  zoneLabel(g_settings.zones[i], i, name, sizeof(name));
+  snprintf(labels, n, "zone=\"%s\"", name);
+  value = bank.percent[i];
+  return true;
+}
+
+static bool collectZoneTemp(int i, char *labels, size_t n, float &value)
+{
+  if (i >= bank.count)
+    return false;
+  char name[20];
+  zoneLabel(g_settings.zones[i], i, name, sizeof(name));
+  snprintf(labels, n, "zone=\"%s\"", name);
+  value = bank.tempC[i];
+  return true;
+}
+
+static MetricCollector mZonePercent("fan_zone_percent", "Control output of each fan zone", MetricType::GAUGE, collectZonePercent);
+static MetricCollector mZoneTemp("fan_zone_temperature_celsius", "Control temperature (estimate, predicted ahead) each fan zone follows", MetricType::GAUGE, collectZoneTemp);
@@ -0,0 +1,147 @@
+#include <Arduino.h>
+#include "project_config.h"
+
+// ============================================================
+// 🧱 Heap fragmentation trend
+// ------------------------------------------------------------
+// Fragmentation = 1 - largest free block / free heap. A heap
+// with plenty of free bytes but no block big enough for a TLS
+// handshake or an OTA buffer shows up here long before an
+// allocation fails.
+//
+// A timer samples once a minute into a 60-entry ring; every
+// hour the worst minute is folded into a 168-entry ring, so one
+// week of uptime fits in ~1.4 KB.
+// ============================================================
+#ifndef HEAP_TREND_PERIOD_MS
+#define HEAP_TREND_PERIOD_MS 60000
+#endif
+#define HEAP_TREND_MINUTES 60
+#define HEAP_TREND_HOURS 168
+
+struct HeapPoint
+{
+  uint16_t fragPm;      // Per mille
+  uint16_t largestKb;
+  uint16_t freeKb;
+};
+
+static HeapPoint minutes[HEAP_TREND_MINUTES];
+static HeapPoint hours[HEAP_TREND_HOURS];
+static uint16_t minuteHead = 0, minuteCount = 0;
+static uint16_t hourHead = 0, hourCount = 0;
+static HeapPoint hourWorst = {};
+static HeapPoint peak = {};           // Worst since boot
+static portMUX_TYPE trendMux = portMUX_INITIALIZER_UNLOCKED;
+
+static HeapPoint heapNow()
+{
+  uint32_t freeB = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  HeapPoint p;
+  p.fragPm = freeB ? 1000 - (uint16_t)((uint64_t)largest * 1000 / freeB) : 0;
+  p.largestKb = largest / 1024;
+  p.freeKb = freeB / 1024;
+  return p;
+}
+
+static void worse(HeapPoint &acc, const HeapPoint &p)
+{
+  acc.fragPm = max(acc.fragPm, p.fragPm);
+  acc.largestKb = acc.largestKb ? min(acc.largestKb, p.largestKb) : p.largestKb;
+  acc.freeKb = acc.freeKb ? min(acc.freeKb, p.freeKb) : p.freeKb;
+}
+
+static void heapTrendSample()
+{
+  HeapPoint p = heapNow();
+
+  portENTER_CRITICAL(&trendMux);
+  minutes[minuteHead] = p;
+  minuteHead = (minuteHead + 1) % HEAP_TREND_MINUTES;
+  if (minuteCount < HEAP_TREND_MINUTES)
+    minuteCount++;
+
+  worse(hourWorst, p);
+  worse(peak, p);
+  if (minuteHead == 0)
+  {
+    hours[hourHead] = hourWorst;
+    hourHead = (hourHead + 1) % HEAP_TREND_HOURS;
+    if (hourCount < HEAP_TREND_HOURS)
+      hourCount++;
+    hourWorst = HeapPoint{};
+  }
+  portEXIT_CRITICAL(&trendMux);
+}
+
+void heapTrendInit()
+{
+  heapTrendSample();
+  setInterval([]
+              { heapTrendSample(); },
+              HEAP_TREND_PERIOD_MS);
+}
+
+static MetricGauge mHeapFrag("heap_fragmentation_ratio", "1 - largest free block / free heap",
+                             []() -> float { return heapNow().fragPm / 1000.0f; });
+
+// ============================================================
+// 📤 /meminfo "heap_trend"
+// ============================================================
+static void fillRing(JsonArray arr, const HeapPoint *ring, uint16_t head, uint16_t count, uint16_t size)
+{
+  for (uint16_t k = 0; k < count; k++)
+    arr.add(ring[(head + size - count + k) % size].fragPm / 1000.0f);
+}
+
+void fillHeapTrend(JsonObject o)
+{
+  HeapPoint now = heapNow();
+  o[F("fragmentation")] = now.fragPm / 1000.0f;
+  o[F("largest_block")] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+  // Copy out so the rings are not read while the timer writes
+  static HeapPoint m[HEAP_TREND_MINUTES], h[HEAP_TREND_HOURS];
+  uint16_t mHead, mCount, hHead, hCount;
+  HeapPoint worst;
+  portENTER_CRITICAL(&trendMux);
+  memcpy(m, minutes, sizeof(m));
+  memcpy(h, hours, sizeof(h));
+  mHead = minuteHead, mCount = minuteCount;
+  hHead = hourHead, hCount = hourCount;
+  worst = peak;
+  portEXIT_CRITICAL(&trendMux);
+
+  o[F("worst")] = worst.fragPm / 1000.0f;
+  o[F("largest_block_min_kb")] = worst.largestKb;
+  fillRing(o[F("minutes")].to<JsonArray>(), m, mHead, mCount, HEAP_TREND_MINUTES);
+  fillRing(o[F("hours")].to<JsonArray>(), h, hHead, hCount, HEAP_TREND_HOURS);
+}
+
+// ============================================================
+// 🖥️ Console `heap`
+// ============================================================
+String heapTrendReport()
+{
+  HeapPoint now = heapNow();
+  HeapPoint worst, lastHour = {};
+  uint16_t hCount;
+
+  portENTER_CRITICAL(&trendMux);
+  worst = peak;
+  hCount = hourCount;
+  for (uint16_t k = 0; k < minuteCount; k++)
+    worse(lastHour, minutes[k]);
+  portEXIT_CRITICAL(&trendMux);
+
+  char out[192];
+  snprintf(out, sizeof(out),
+           "Free heap=%u KB, largest block=%u KB, fragmentation=%.1f%%\n"
+           "last hour: worst %.1f%%, largest block >= %u KB\n"
+           "since boot (%u h): worst %.1f%%, largest block >= %u KB\n",
+           now.freeKb, now.largestKb, now.fragPm / 10.0f,
+           lastHour.fragPm / 10.0f, lastHour.largestKb,
+           hCount, worst.fragPm / 10.0f, worst.largestKb);
+  return out;
+}
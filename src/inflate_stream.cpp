@@ -0,0 +1,221 @@
+#include <Arduino.h>
+#include "inflate_stream.h"
+#include "project_config.h"
+#include "esp_rom_crc.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/miniz.h"
+#elif CONFIG_IDF_TARGET_ESP32S2
+#include "esp32s2/rom/miniz.h"
+#elif CONFIG_IDF_TARGET_ESP32C3
+#include "esp32c3/rom/miniz.h"
+#else
+#include "esp32/rom/miniz.h"
+#endif
+
+// The window doubles as tinfl's circular output buffer
+static constexpr size_t WINDOW_SIZE = TINFL_LZ_DICT_SIZE;
+
+// RFC 1952 header flags
+#define GZ_FHCRC 0x02
+#define GZ_FEXTRA 0x04
+#define GZ_FNAME 0x08
+#define GZ_FCOMMENT 0x10
+
+size_t InflateStream::memoryUse()
+{
+  return sizeof(tinfl_decompressor) + WINDOW_SIZE;
+}
+
+bool InflateStream::begin(Format format)
+{
+  end();
+
+  decomp_ = malloc(sizeof(tinfl_decompressor));
+  window_ = (uint8_t *)malloc(WINDOW_SIZE);
+  if (!decomp_ || !window_)
+  {
+    LOGE("[INFLATE] Out of memory (%u bytes needed)", (unsigned)memoryUse());
+    end();
+    return false;
+  }
+
+  tinfl_init((tinfl_decompressor *)decomp_);
+  flags_ = TINFL_FLAG_HAS_MORE_INPUT | (format == ZLIB ? TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_COMPUTE_ADLER32 : 0);
+  outPos_ = 0;
+  produced_ = 0;
+  done_ = false;
+  gz_ = format == GZIP ? GzState::HEADER : GzState::NONE;
+  gzFill_ = 0;
+  crc_ = 0;
+  return true;
+}
+
+// ============================================================
+// 📎 GZIP framing
+// ============================================================
+// Move to the next optional header field present in the flags
+void InflateStream::enterGzState(GzState after)
+{
+  gzFill_ = 0;
+  if (after < GzState::XLEN && (gzFlags_ & GZ_FEXTRA))
+    gz_ = GzState::XLEN;
+  else if (after < GzState::NAME && (gzFlags_ & GZ_FNAME))
+    gz_ = GzState::NAME;
+  else if (after < GzState::COMMENT && (gzFlags_ & GZ_FCOMMENT))
+    gz_ = GzState::COMMENT;
+  else if (after < GzState::HCRC && (gzFlags_ & GZ_FHCRC))
+  {
+    gz_ = GzState::HCRC;
+    gzSkip_ = 2;
+  }
+  else
+    gz_ = GzState::BODY;
+}
+
+// Consumes header bytes from data/len; the header may span feeds
+bool InflateStream::parseGzipHeader(const uint8_t *&data, size_t &len)
+{
+  while (len && gz_ != GzState::BODY)
+  {
+    switch (gz_)
+    {
+    case GzState::HEADER:
+    case GzState::XLEN:
+    {
+      size_t want = gz_ == GzState::HEADER ? 10 : 2;
+      size_t n = min(len, want - gzFill_);
+      memcpy(gzBuf_ + gzFill_, data, n);
+      gzFill_ += n;
+      data += n;
+      len -= n;
+      if (gzFill_ < want)
+        break;
+
+      if (gz_ == GzState::HEADER)
+      {
+        if (gzBuf_[0] != 0x1f || gzBuf_[1] != 0x8b || gzBuf_[2] != 8)
+        {
+          LOGE("[INFLATE] Not a gzip/deflate stream");
+          return false;
+        }
+        gzFlags_ = gzBuf_[3];
+        enterGzState(GzState::HEADER);
+      }
+      else
+      {
+        gzSkip_ = gzBuf_[0] | (gzBuf_[1] << 8);
+        gz_ = GzState::EXTRA;
+      }
+      break;
+    }
+
+    case GzState::EXTRA:
+    case GzState::HCRC:
+    {
+      size_t n = min(len, gzSkip_);
+      data += n;
+      len -= n;
+      gzSkip_ -= n;
+      if (!gzSkip_)
+        enterGzState(gz_);
+      break;
+    }
+
+    case GzState::NAME:
+    case GzState::COMMENT:
+      len--;
+      if (*data++ == 0)
+        enterGzState(gz_);
+      break;
+
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+bool InflateStream::checkGzipTrailer()
+{
+  uint32_t crc = gzBuf_[0] | (gzBuf_[1] << 8) | (gzBuf_[2] << 16) | ((uint32_t)gzBuf_[3] << 24);
+  uint32_t size = gzBuf_[4] | (gzBuf_[5] << 8) | (gzBuf_[6] << 16) | ((uint32_t)gzBuf_[7] << 24);
+  if (crc != crc_ || size != (uint32_t)produced_)
+  {
+    LOGE("[INFLATE] gzip trailer mismatch (crc %08lx/%08lx, size %lu/%u)",
+         (unsigned long)crc, (unsigned long)crc_, (unsigned long)size, (unsigned)produced_);
+    return false;
+  }
+  return true;
+}
+
+bool InflateStream::feed(const uint8_t *data, size_t len, InflateSink sink, void *ctx)
+{
+  if (!decomp_)
+    return false;
+
+  if (gz_ != GzState::NONE && gz_ < GzState::BODY)
+  {
+    if (!parseGzipHeader(data, len))
+      return false;
+    if (gz_ != GzState::BODY)
+      return true;
+  }
+
+  while (!done_ && gz_ != GzState::TRAILER)
+  {
+    size_t inBytes = len;
+    size_t outBytes = WINDOW_SIZE - outPos_;
+    tinfl_status status = tinfl_decompress((tinfl_decompressor *)decomp_, data, &inBytes,
+                                           window_, window_ + outPos_, &outBytes, flags_);
+    data += inBytes;
+    len -= inBytes;
+
+    if (outBytes)
+    {
+      produced_ += outBytes;
+      if (gz_ == GzState::BODY)
+        crc_ = esp_rom_crc32_le(crc_, window_ + outPos_, outBytes);
+      if (!sink(window_ + outPos_, outBytes, ctx))
+        return false;
+      outPos_ = (outPos_ + outBytes) & (WINDOW_SIZE - 1);
+    }
+
+    if (status == TINFL_STATUS_DONE)
+    {
+      if (gz_ == GzState::BODY)
+        gz_ = GzState::TRAILER;
+      else
+        done_ = true;
+    }
+    else if (status < TINFL_STATUS_DONE)
+    {
+      LOGE("[INFLATE] Corrupt stream (status %d)", (int)status);
+      return false;
+    }
+    else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0)
+      break;
+  }
+
+  if (gz_ == GzState::TRAILER && !done_)
+  {
+    size_t n = min(len, 8 - gzFill_);
+    memcpy(gzBuf_ + gzFill_, data, n);
+    gzFill_ += n;
+    if (gzFill_ == 8)
+    {
+      if (!checkGzipTrailer())
+        return false;
+      done_ = true;
+    }
+  }
+  return true;
+}
+
+void InflateStream::end()
+{
+  free(decomp_);
+  free(window_);
+  decomp_ = nullptr;
+  window_ = nullptr;
+}
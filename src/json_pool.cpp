@@ -0,0 +1,305 @@
+#include <Arduino.h>
+#include "project_config.h"
+#include "json_pool.h"
+
+// ==========================================================
+// 🧱 Static pool storage
+// ==========================================================
+alignas(8) static uint8_t poolMemory[JSON_POOL_COUNT][JSON_POOL_SIZE];
+
+struct JsonPoolSlot
+{
+  JsonArena arena;
+  TaskHandle_t owner;           // nullptr when free or retained
+  uint8_t depth;
+  bool retained;                // Held by a response until jsonPoolRelease()
+  uint32_t uses;
+  char lastTask[16];
+};
+
+static JsonPoolSlot pools[JSON_POOL_COUNT] = {
+#if JSON_POOL_COUNT > 0
+    {JsonArena(poolMemory[0], JSON_POOL_SIZE), nullptr, 0, false, 0, ""},
+#endif
+#if JSON_POOL_COUNT > 1
+    {JsonArena(poolMemory[1], JSON_POOL_SIZE), nullptr, 0, false, 0, ""},
+#endif
+#if JSON_POOL_COUNT > 2
+    {JsonArena(poolMemory[2], JSON_POOL_SIZE), nullptr, 0, false, 0, ""},
+#endif
+#if JSON_POOL_COUNT > 3
+    {JsonArena(poolMemory[3], JSON_POOL_SIZE), nullptr, 0, false, 0, ""},
+#endif
+};
+static_assert(JSON_POOL_COUNT <= 4, "Extend the pools[] initializer for more than 4 pools");
+
+// Used when every pool is taken by another task: zero capacity,
+// so each allocation goes to the heap and is counted.
+static JsonArena heapFallback(nullptr, 0);
+static uint32_t noPoolCount = 0;
+
+static portMUX_TYPE poolMux = portMUX_INITIALIZER_UNLOCKED;
+
+// ==========================================================
+// 🧮 JsonArena
+// ==========================================================
+void *JsonArena::allocate(size_t size)
+{
+  size_t need = HEADER + align8(size);
+  if (used_ + need <= capacity_)
+  {
+    uint8_t *block = buf_ + used_;
+    *(uint32_t *)block = align8(size);
+    last_ = used_;
+    used_ += need;
+    if (used_ > highWater_)
+      highWater_ = used_;
+    return block + HEADER;
+  }
+
+  overflows_++;
+  return malloc(size);
+}
+
+void JsonArena::deallocate(void *ptr)
+{
+  if (!ptr)
+    return;
+
+  if (!owns(ptr))
+  {
+    free(ptr);
+    return;
+  }
+
+  // Only the top block can be given back before reset()
+  if (isLast(ptr))
+  {
+    used_ = last_;
+    last_ = NO_BLOCK;
+  }
+}
+
+void *JsonArena::reallocate(void *ptr, size_t new_size)
+{
+  if (!ptr)
+    return allocate(new_size);
+
+  if (!owns(ptr))
+    return realloc(ptr, new_size);
+
+  uint32_t &size = blockSize(ptr);
+  size_t want = align8(new_size);
+
+  // Shrink or grow the top block in place
+  if (isLast(ptr) && last_ + HEADER + want <= capacity_)
+  {
+    size = want;
+    used_ = last_ + HEADER + want;
+    if (used_ > highWater_)
+      highWater_ = used_;
+    return ptr;
+  }
+
+  // Shrinking an inner block: keep it where it is
+  if (want <= size)
+    return ptr;
+
+  void *moved = allocate(new_size);
+  if (moved)
+  {
+    memcpy(moved, ptr, size);
+    deallocate(ptr);
+  }
+  return moved;
+}
+
+// ==========================================================
+// 🔒 JsonArenaScope
+// ==========================================================
+JsonArenaScope::JsonArenaScope() : arena_(&heapFallback), slot_(-1)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+  portENTER_CRITICAL(&poolMux);
+  for (int i = 0; i < JSON_POOL_COUNT && slot_ < 0; i++)
+  {
+    if (pools[i].owner == self)
+      slot_ = i;
+  }
+  for (int i = 0; i < JSON_POOL_COUNT && slot_ < 0; i++)
+  {
+    if (!pools[i].owner && !pools[i].retained)
+    {
+      pools[i].owner = self;
+      pools[i].uses++;
+      slot_ = i;
+    }
+  }
+  if (slot_ >= 0)
+    pools[slot_].depth++;
+  else
+    noPoolCount++;
+  portEXIT_CRITICAL(&poolMux);
+
+  if (slot_ >= 0)
+  {
+    arena_ = &pools[slot_].arena;
+    if (pools[slot_].depth == 1)
+      strlcpy(pools[slot_].lastTask, pcTaskGetName(nullptr), sizeof(pools[slot_].lastTask));
+  }
+}
+
+JsonArenaScope::~JsonArenaScope()
+{
+  if (slot_ < 0)
+    return;
+
+  portENTER_CRITICAL(&poolMux);
+  if (--pools[slot_].depth == 0)
+  {
+    pools[slot_].arena.reset();
+    pools[slot_].owner = nullptr;
+    pools[slot_].retained = false;
+  }
+  portEXIT_CRITICAL(&poolMux);
+}
+
+// The pool leaves the task: the next request on it claims a fresh
+// one instead of stacking on top of a body still being sent, and
+// this one resets once the response lets go.
+int JsonArenaScope::retain()
+{
+  if (slot_ < 0)
+    return -1;
+  portENTER_CRITICAL(&poolMux);
+  pools[slot_].depth++;
+  pools[slot_].owner = nullptr;
+  pools[slot_].retained = true;
+  portEXIT_CRITICAL(&poolMux);
+  return slot_;
+}
+
+// May run on another task than the owner (response teardown)
+void jsonPoolRelease(int slot)
+{
+  if (slot < 0 || slot >= JSON_POOL_COUNT)
+    return;
+
+  portENTER_CRITICAL(&poolMux);
+  if (pools[slot].depth && --pools[slot].depth == 0)
+  {
+    pools[slot].arena.reset();
+    pools[slot].owner = nullptr;
+    pools[slot].retained = false;
+  }
+  portEXIT_CRITICAL(&poolMux);
+}
+
+// ==========================================================
+// ✍️ TextBuilder
+// ==========================================================
+TextBuilder::TextBuilder(JsonArenaScope &scope, size_t capacity)
+    : scope_(scope), alloc_(scope.allocator()), cap_(capacity)
+{
+  buf_ = (char *)alloc_->allocate(cap_ + 1);
+  if (!buf_)
+    cap_ = 0;
+  else
+    buf_[0] = 0;
+}
+
+TextBuilder::~TextBuilder()
+{
+  if (buf_)
+    alloc_->deallocate(buf_);
+}
+
+size_t TextBuilder::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t TextBuilder::write(const uint8_t *data, size_t n)
+{
+  size_t room = cap_ - len_;
+  if (n > room)
+  {
+    truncated_ = true;
+    n = room;
+  }
+  if (n)
+  {
+    memcpy(buf_ + len_, data, n);
+    len_ += n;
+    buf_[len_] = 0;
+  }
+  return n;
+}
+
+size_t TextBuilder::printf(const char *fmt, ...)
+{
+  if (!buf_)
+  {
+    truncated_ = true;
+    return 0;
+  }
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf_ + len_, cap_ - len_ + 1, fmt, args);
+  va_end(args);
+  if (n < 0)
+    return 0;
+
+  size_t wrote = min((size_t)n, cap_ - len_);
+  if (wrote < (size_t)n)
+    truncated_ = true;
+  len_ += wrote;
+  return wrote;
+}
+
+char *TextBuilder::release(ArduinoJson::Allocator *&alloc, int &slot)
+{
+  char *out = buf_;
+  alloc = alloc_;
+  slot = scope_.retain();
+  buf_ = nullptr;
+  cap_ = len_ = 0;
+  return out;
+}
+
+// ==========================================================
+// 📊 Pool statistics
+// ==========================================================
+String jsonPoolReport()
+{
+  String out = "=== JSON pools ===\n";
+  char line[112];
+  for (int i = 0; i < JSON_POOL_COUNT; i++)
+  {
+    const JsonPoolSlot &p = pools[i];
+    snprintf(line, sizeof(line), "pool%d: high_water=%u/%u uses=%lu overflows=%lu last=%s\n",
+             i, (unsigned)p.arena.highWater(), (unsigned)p.arena.capacity(),
+             (unsigned long)p.uses, (unsigned long)p.arena.overflows(), p.lastTask);
+    out += line;
+  }
+  snprintf(line, sizeof(line), "no free pool: %lu (heap allocations: %lu)\n",
+           (unsigned long)noPoolCount, (unsigned long)heapFallback.overflows());
+  out += line;
+  return out;
+}
+
+void fillJsonPoolStats(JsonArray out)
+{
+  for (int i = 0; i < JSON_POOL_COUNT; i++)
+  {
+    JsonObject p = out.add<JsonObject>();
+    p[F("capacity")] = pools[i].arena.capacity();
+    p[F("high_water")] = pools[i].arena.highWater();
+    p[F("uses")] = pools[i].uses;
+    p[F("overflows")] = pools[i].arena.overflows();
+  }
+  JsonObject fb = out.add<JsonObject>();
+  fb[F("no_pool")] = noPoolCount;
+  fb[F("overflows")] = heapFallback.overflows();
+}
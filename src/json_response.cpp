@@ -0,0 +1,389 @@
+#include <Arduino.h>
+#include "project_config.h"
+#include <ESPAsyncWebServer.h>
+#include <ArduinoJson.h>
+
+// ==========================================================
+// 📊 Per-endpoint serialization stats
+// ----------------------------------------------------------
+// Filled by sendJson() for every JSON/MessagePack response, so the cost of
+// each API endpoint can be read back with `json_stats`.
+// ==========================================================
+#define JSON_STATS_SLOTS 16
+
+struct JsonEndpointStats
+{
+    char url[32];
+    uint32_t count;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint32_t total_us;
+    uint32_t bytes;
+    uint32_t heap_peak;   // Largest heap drop seen while building + serializing
+};
+
+static JsonEndpointStats jsonStats[JSON_STATS_SLOTS];
+
+static JsonEndpointStats *statsFor(const String &url)
+{
+    for (auto &s : jsonStats)
+    {
+        if (s.url[0] && url.equals(s.url))
+            return &s;
+    }
+    for (auto &s : jsonStats)
+    {
+        if (!s.url[0])
+        {
+            strlcpy(s.url, url.c_str(), sizeof(s.url));
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+static void recordStats(AsyncWebServerRequest *req, uint32_t us, size_t bytes, uint32_t heapDrop)
+{
+    JsonEndpointStats *s = statsFor(req->url());
+    if (!s)
+        return;
+    s->count++;
+    s->last_us = us;
+    s->total_us += us;
+    s->bytes = bytes;
+    if (us > s->max_us)
+        s->max_us = us;
+    if (heapDrop > s->heap_peak)
+        s->heap_peak = heapDrop;
+}
+
+// ==========================================================
+// 🤝 Content negotiation
+// ----------------------------------------------------------
+// MessagePack when the client sends `Accept: application/msgpack`
+// or `?format=msgpack`; pretty JSON only on ?pretty=1; compact
+// JSON otherwise. The payload comes from the same JsonFiller.
+// ==========================================================
+enum class PayloadFormat : uint8_t
+{
+    JSON,
+    JSON_PRETTY,
+    MSGPACK
+};
+
+static PayloadFormat negotiateFormat(AsyncWebServerRequest *req)
+{
+    if (req->hasParam("format"))
+    {
+        const String &f = req->getParam("format")->value();
+        if (f.equalsIgnoreCase("msgpack"))
+            return PayloadFormat::MSGPACK;
+        if (f.equalsIgnoreCase("json"))
+            return PayloadFormat::JSON;
+    }
+    if (req->hasHeader("Accept") && req->header("Accept").indexOf("msgpack") >= 0)
+        return PayloadFormat::MSGPACK;
+    if (req->hasParam("pretty") && req->getParam("pretty")->value() != "0")
+        return PayloadFormat::JSON_PRETTY;
+    return PayloadFormat::JSON;
+}
+
+// ==========================================================
+// 📤 Serialize a document straight into the response
+// ----------------------------------------------------------
+// The response buffer is sized from measureJson(), so it is
+// allocated once and never grows; no intermediate String.
+// ==========================================================
+static size_t streamJson(AsyncWebServerRequest *req, const JsonDocument &doc, int code)
+{
+    PayloadFormat fmt = negotiateFormat(req);
+    size_t len;
+    AsyncResponseStream *response;
+
+    switch (fmt)
+    {
+    case PayloadFormat::MSGPACK:
+        len = measureMsgPack(doc);
+        response = req->beginResponseStream("application/msgpack", len + 1);
+        serializeMsgPack(doc, *response);
+        break;
+    case PayloadFormat::JSON_PRETTY:
+        len = measureJsonPretty(doc);
+        response = req->beginResponseStream("application/json", len + 1);
+        serializeJsonPretty(doc, *response);
+        break;
+    default:
+        len = measureJson(doc);
+        response = req->beginResponseStream("application/json", len + 1);
+        serializeJson(doc, *response);
+        break;
+    }
+
+    response->setCode(code);
+    response->addHeader("Vary", "Accept");
+    req->send(response);
+    return len;
+}
+
+void sendJson(AsyncWebServerRequest *req, const JsonDocument &doc, int code)
+{
+    uint32_t t0 = micros();
+    uint32_t heap0 = ESP.getFreeHeap();
+    size_t len = streamJson(req, doc, code);
+    recordStats(req, micros() - t0, len, heap0 - min(heap0, ESP.getFreeHeap()));
+}
+
+void sendJson(AsyncWebServerRequest *req, JsonFiller fill, int code)
+{
+    uint32_t t0 = micros();
+    uint32_t heap0 = ESP.getFreeHeap();
+    uint32_t heapMin = heap0;
+    size_t len;
+    {
+        JsonArenaScope arena;
+        JsonDocument doc(arena.allocator());
+        fill(doc);
+        heapMin = min(heapMin, ESP.getFreeHeap());
+        len = streamJson(req, doc, code);
+        heapMin = min(heapMin, ESP.getFreeHeap());
+    }
+    recordStats(req, micros() - t0, len, heap0 - heapMin);
+}
+
+// ==========================================================
+// ✍️ Plain responses without a String body
+// ----------------------------------------------------------
+// AsyncWebServerRequest::send(code, type, String) copies the
+// body into the response. These point the response at memory
+// that outlives it instead: a TextBuilder buffer (kept in the
+// request pool until the response is destroyed) or a literal.
+// ==========================================================
+class PooledTextResponse : public AsyncProgmemResponse
+{
+public:
+    PooledTextResponse(int code, const char *type, char *text, size_t len,
+                       ArduinoJson::Allocator *alloc, int slot)
+        : AsyncProgmemResponse(code, type, (const uint8_t *)text, len), text_(text), alloc_(alloc), slot_(slot) {}
+
+    ~PooledTextResponse()
+    {
+        if (text_)
+            alloc_->deallocate(text_);
+        jsonPoolRelease(slot_);
+    }
+
+private:
+    char *text_;
+    ArduinoJson::Allocator *alloc_;
+    int slot_;
+};
+
+void sendText(AsyncWebServerRequest *req, int code, const char *type, TextBuilder &text)
+{
+    size_t len = text.length();
+    ArduinoJson::Allocator *alloc;
+    int slot;
+    char *buf = text.release(alloc, slot);
+    req->send(new PooledTextResponse(code, type, buf, len, alloc, slot));
+}
+
+void sendConst(AsyncWebServerRequest *req, int code, const char *type, const char *text)
+{
+    req->send(new AsyncProgmemResponse(code, type, (const uint8_t *)text, strlen(text)));
+}
+
+// ==========================================================
+// 📋 Live stats dump (console: json_stats)
+// ==========================================================
+String jsonStatsReport()
+{
+    String out = "=== JSON endpoints ===\n";
+    char line[112];
+    for (auto &s : jsonStats)
+    {
+        if (!s.url[0])
+            continue;
+        snprintf(line, sizeof(line), "%-24s n=%lu avg=%luus max=%luus bytes=%lu heap_peak=%lu\n",
+                 s.url, (unsigned long)s.count,
+                 (unsigned long)(s.count ? s.total_us / s.count : 0),
+                 (unsigned long)s.max_us, (unsigned long)s.bytes, (unsigned long)s.heap_peak);
+        out += line;
+    }
+    return out;
+}
+
+// ==========================================================
+// ⏱️ Synthetic benchmark (console: bench_json)
+// ----------------------------------------------------------
+// Compares the old path (pretty String + copy into the
+// response) with the streamed path (compact, written in
+// TCP-sized chunks into a fixed buffer, document in a JSON
+// pool) for every endpoint.
+// ==========================================================
+class ChunkSink : public Print
+{
+public:
+    size_t write(uint8_t c) override
+    {
+        chunk[fill++] = c;
+        if (fill == sizeof(chunk))
+            fill = 0;
+        total++;
+        return 1;
+    }
+    size_t write(const uint8_t *buf, size_t n) override
+    {
+        for (size_t i = 0; i < n; i++)
+            write(buf[i]);
+        return n;
+    }
+    size_t total = 0;
+
+private:
+    uint8_t chunk[1460];
+    size_t fill = 0;
+};
+
+struct BenchResult
+{
+    uint32_t us;
+    uint32_t heap_peak;
+    size_t bytes;
+};
+
+static BenchResult benchString(JsonFiller fill, int iterations)
+{
+    BenchResult r = {0, 0, 0};
+    uint32_t t0 = micros();
+    for (int i = 0; i < iterations; i++)
+    {
+        uint32_t heap0 = ESP.getFreeHeap();
+        JsonDocument doc;
+        fill(doc);
+        String output;
+        serializeJsonPretty(doc, output);
+        String copy = output;   // What beginResponse(String) does
+        uint32_t drop = heap0 - min(heap0, ESP.getFreeHeap());
+        r.heap_peak = max(r.heap_peak, drop);
+        r.bytes = copy.length();
+    }
+    r.us = (micros() - t0) / iterations;
+    return r;
+}
+
+static BenchResult benchStream(JsonFiller fill, int iterations)
+{
+    static ChunkSink sink;
+    BenchResult r = {0, 0, 0};
+    uint32_t t0 = micros();
+    for (int i = 0; i < iterations; i++)
+    {
+        uint32_t heap0 = ESP.getFreeHeap();
+        JsonArenaScope arena;
+        JsonDocument doc(arena.allocator());
+        fill(doc);
+        sink.total = 0;
+        serializeJson(doc, sink);
+        uint32_t drop = heap0 - min(heap0, ESP.getFreeHeap());
+        r.heap_peak = max(r.heap_peak, drop);
+        r.bytes = sink.total;
+    }
+    r.us = (micros() - t0) / iterations;
+    return r;
+}
+
+String jsonBenchReport(int iterations)
+{
+    struct Endpoint
+    {
+        const char *name;
+        JsonFiller fill;
+    };
+    const Endpoint endpoints[] = {
+        {"/status", fillJson},
+        {"/meminfo", fillMemInfo},
+        {"/wifi_info", fillWifiInfo},
+        {"/api/sensors", fillSensors},
+        {"/api/settings", fillSettings},
+    };
+
+    if (iterations <= 0)
+        iterations = 20;
+
+    String out = "=== bench_json (" + String(iterations) + " iterations) ===\n";
+    char line[128];
+    for (auto &e : endpoints)
+    {
+        BenchResult a = benchString(e.fill, iterations);
+        BenchResult b = benchStream(e.fill, iterations);
+        snprintf(line, sizeof(line), "%-14s string: %5luus %5luB heap %5lu | stream: %5luus %5luB heap %5lu\n",
+                 e.name,
+                 (unsigned long)a.us, (unsigned long)a.bytes, (unsigned long)a.heap_peak,
+                 (unsigned long)b.us, (unsigned long)b.bytes, (unsigned long)b.heap_peak);
+        out += line;
+    }
+    return out;
+}
+
+// ==========================================================
+// 📦 Wire format benchmark (console: bench_fmt)
+// ----------------------------------------------------------
+// Bytes on the wire and serialization time of the telemetry
+// payloads as pretty JSON (old), compact JSON and MessagePack.
+// ==========================================================
+template <typename Serializer>
+static BenchResult benchFormat(const JsonDocument &doc, int iterations, Serializer serialize)
+{
+    static ChunkSink sink;
+    BenchResult r = {0, 0, 0};
+    uint32_t t0 = micros();
+    for (int i = 0; i < iterations; i++)
+    {
+        sink.total = 0;
+        serialize(doc, sink);
+    }
+    r.us = (micros() - t0) / iterations;
+    r.bytes = sink.total;
+    return r;
+}
+
+String formatBenchReport(int iterations)
+{
+    struct Payload
+    {
+        const char *name;
+        JsonFiller fill;
+    };
+    const Payload payloads[] = {
+        {"/api/sensors", fillSensors},
+        {"/api/settings", fillSettings},
+        {"/status", fillJson},
+    };
+
+    if (iterations <= 0)
+        iterations = 50;
+
+    String out = "=== bench_fmt (" + String(iterations) + " iterations) ===\n";
+    char line[128];
+    for (auto &p : payloads)
+    {
+        JsonArenaScope arena;
+        JsonDocument doc(arena.allocator());
+        p.fill(doc);
+
+        BenchResult pretty = benchFormat(doc, iterations, [](const JsonDocument &d, Print &o)
+                                         { serializeJsonPretty(d, o); });
+        BenchResult compact = benchFormat(doc, iterations, [](const JsonDocument &d, Print &o)
+                                          { serializeJson(d, o); });
+        BenchResult msgpack = benchFormat(doc, iterations, [](const JsonDocument &d, Print &o)
+                                          { serializeMsgPack(d, o); });
+
+        snprintf(line, sizeof(line), "%-14s pretty: %4uB %4luus | json: %4uB %4luus | msgpack: %4uB %4luus\n",
+                 p.name,
+                 (unsigned)pretty.bytes, (unsigned long)pretty.us,
+                 (unsigned)compact.bytes, (unsigned long)compact.us,
+                 (unsigned)msgpack.bytes, (unsigned long)msgpack.us);
+        out += line;
+    }
+    return out;
+}
@@ -32,6 +32,10 @@ void fillFromJson(SystemSettings &s, const JsonDocument &doc)
     s.adc_samples = doc["adc_samples"] | s.adc_samples;
     if (doc["temp_sensor_type"].is<String>())
         s.temp_sensor_type = (const char *)doc["temp_sensor_type"];
+    s.temp_filter_enabled = doc["temp_filter_enabled"] | s.temp_filter_enabled;
+    s.temp_predict_s = constrain(doc["temp_predict_s"] | s.temp_predict_s, 0.0f, 30.0f);
+    s.temp_fuse_ntc = doc["temp_fuse_ntc"] | s.temp_fuse_ntc;
+    s.temp_stale_ms = max<uint16_t>(doc["temp_stale_ms"] | s.temp_stale_ms, 1000);
 
     // --- Fan Control ---
     if (doc["fan_mode"].is<String>())
@@ -48,12 +52,26 @@ void fillFromJson(SystemSettings &s, const JsonDocument &doc)
     s.fan_control_interval = doc["fan_control_interval"] | s.fan_control_interval;
     s.manual_percent = doc["manual_percent"] | s.manual_percent;
     s.fan_start_boost_ms = doc["fan_start_boost_ms"] | s.fan_start_boost_ms;
+    s.fan_start_boost_pct = min<uint8_t>(doc["fan_start_boost_pct"] | s.fan_start_boost_pct, 100);
+    s.fan_slew_pct_per_s = doc["fan_slew_pct_per_s"] | s.fan_slew_pct_per_s;
+    s.fan_tach_enabled = doc["fan_tach_enabled"] | s.fan_tach_enabled;
+    s.fan_tach_ppr = max<uint8_t>(doc["fan_tach_ppr"] | s.fan_tach_ppr, 1);
+    s.fan_rpm_window_ms = doc["fan_rpm_window_ms"] | s.fan_rpm_window_ms;
+    s.fan_stall_ms = doc["fan_stall_ms"] | s.fan_stall_ms;
+    s.fan_max_rpm = doc["fan_max_rpm"] | s.fan_max_rpm;
+    s.fan_closed_loop = doc["fan_closed_loop"] | s.fan_closed_loop;
+    s.fan_failsafe_pct = min<uint8_t>(doc["fan_failsafe_pct"] | s.fan_failsafe_pct, 100);
     s.pwm_freq_hz = doc["pwm_freq_hz"] | s.pwm_freq_hz;
     s.pwm_channel = doc["pwm_channel"] | s.pwm_channel;
     s.pwm_resolution_bits = doc["pwm_resolution_bits"] | s.pwm_resolution_bits;
     s.invert_pwm = doc["invert_pwm"] | s.invert_pwm;
     s.manual_on = doc["manual_on"] | s.manual_on;
 
+    // --- Fan Zones ---
+    if (doc["zones"].is<JsonArrayConst>())
+        zonesFromJson(s, doc["zones"].as<JsonArrayConst>());
+    syncPrimaryZone(s);
+
     // --- UI Mapping & Alarm ---
     s.ui_system_min = doc["ui_system_min"] | s.ui_system_min;
     s.ui_system_max = doc["ui_system_max"] | s.ui_system_max;
@@ -80,7 +98,8 @@ SettingsLoadStatus settingsLoadFromFS()
         return LOAD_FILE_OPEN_FAIL;
     }
 
-    JsonDocument doc;
+    JsonArenaScope arena;
+    JsonDocument doc(arena.allocator());
     DeserializationError err = deserializeJson(doc, f);
     f.close();
 
@@ -135,12 +154,16 @@ void loadSettings()
 // =========================================================
 void settingsApply()
 {
+    settingsTouch();
+
     // Reinitialize PWM with new configuration
     reinitPwm(
         g_settings.pwm_channel,
         g_settings.pwm_freq_hz,
         g_settings.pwm_resolution_bits,
         g_settings.invert_pwm);
+    fanTachInit();
+    tempFusionConfigure();
 
     // Apply manual fan state (if active)
     applyManualFan(g_settings.manual_on, static_cast<uint8_t>(g_settings.manual_percent));
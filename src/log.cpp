@@ -1,39 +1,162 @@
 #include <cstdarg>
+#include <sys/time.h>
 #include "project_config.h"
 
 // ==========================================================
-// 🧠 Circular runtime log buffer
+// 🧠 Log records
+// ----------------------------------------------------------
+// Lines are stored as raw records (monotonic µs, wall-clock
+// seconds/ms, level, text) and only formatted when the log is
+// shown. Two stores:
+//   setup   – first 10 s of boot, append-only
+//   runtime – circular, oldest records are dropped
 // ==========================================================
-String logBufferSetup;                         // Boot logs (first seconds)
-char logBufferRuntime[LOG_BUFFER_SIZE];        // Circular buffer for runtime logs
-size_t logHead = 0;                            // Current write index
+struct __attribute__((packed)) LogRecord
+{
+    int64_t us;         // mono_us() when logged
+    uint32_t wallSec;   // Unix seconds, 0 if the clock was not set
+    uint16_t wallMs;
+    char level;         // 'E','W','I','D','T', or 0 for raw lines
+    uint16_t len;       // Text bytes that follow the header
+};
+
+static uint8_t logSetup[LOG_SETUP_SIZE];
+static size_t setupUsed = 0;
+static uint32_t setupDropped = 0;
+
+static uint8_t logRuntime[LOG_BUFFER_SIZE];
+static size_t runHead = 0;   // Next write position
+static size_t runTail = 0;   // Oldest record
+static size_t runUsed = 0;
+
+static SemaphoreHandle_t logMutex = nullptr;
+
+struct LogLock
+{
+    LogLock()
+    {
+        if (!logMutex)
+            logMutex = xSemaphoreCreateMutex();
+        xSemaphoreTake(logMutex, portMAX_DELAY);
+    }
+    ~LogLock() { xSemaphoreGive(logMutex); }
+};
 
 // ==========================================================
-// 📜 Add message to setup log (before main runtime)
+// 🔁 Ring helpers (runtime store)
 // ==========================================================
-void addLogSetup(const String &msg)
+static void ringWrite(const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    size_t first = min(len, LOG_BUFFER_SIZE - runHead);
+    memcpy(logRuntime + runHead, p, first);
+    memcpy(logRuntime, p + first, len - first);
+    runHead = (runHead + len) % LOG_BUFFER_SIZE;
+}
+
+static void ringRead(size_t pos, void *out, size_t len)
 {
-    logBufferSetup += msg + "\n";
+    uint8_t *p = (uint8_t *)out;
+    size_t first = min(len, LOG_BUFFER_SIZE - pos);
+    memcpy(p, logRuntime + pos, first);
+    memcpy(p + first, logRuntime, len - first);
+}
+
+static void storeRecord(const LogRecord &rec, const char *text)
+{
+    size_t need = sizeof(LogRecord) + rec.len;
+
+    if (ts_ms() < 10000)   // Boot logs (first 10s)
+    {
+        if (setupUsed + need > sizeof(logSetup))
+        {
+            setupDropped++;
+            return;
+        }
+        memcpy(logSetup + setupUsed, &rec, sizeof(rec));
+        memcpy(logSetup + setupUsed + sizeof(rec), text, rec.len);
+        setupUsed += need;
+        return;
+    }
+
+    if (need > LOG_BUFFER_SIZE)
+        return;   // Ignore too-long messages
+
+    while (LOG_BUFFER_SIZE - runUsed < need)
+    {
+        LogRecord old;
+        ringRead(runTail, &old, sizeof(old));
+        size_t sz = sizeof(old) + old.len;
+        runTail = (runTail + sz) % LOG_BUFFER_SIZE;
+        runUsed -= sz;
+    }
+    ringWrite(&rec, sizeof(rec));
+    ringWrite(text, rec.len);
+    runUsed += need;
+}
+
+static LogRecord makeRecord(char level, size_t len)
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+
+    LogRecord rec;
+    rec.us = mono_us();
+    rec.wallSec = tv.tv_sec >= 1577836800 ? (uint32_t)tv.tv_sec : 0;   // Before 2020: clock not set
+    rec.wallMs = tv.tv_usec / 1000;
+    rec.level = level;
+    rec.len = (uint16_t)min<size_t>(len, 0xFFFF);
+    return rec;
 }
 
 // ==========================================================
-// 📜 Add message to circular runtime log
+// 🕒 Timestamp formatting, cached per second
+// ----------------------------------------------------------
+// "YYYY-MM-DD HH:MM:SS" is rebuilt only when the second
+// changes; each line just appends ".mmm". Without wall time
+// the uptime "+<s>.<ms>" is used.
 // ==========================================================
-void addLog(const char *msg)
+struct StampCache
 {
-    size_t len = strlen(msg);
-    if (len + 2 >= LOG_BUFFER_SIZE)
-        return; // Ignore too-long messages
+    uint32_t sec = UINT32_MAX;
+    char text[20];
+};
 
-    for (size_t i = 0; i < len; i++)
+static void formatStamp(StampCache &cache, char *out, size_t n, uint32_t wallSec, uint16_t wallMs, int64_t us)
+{
+    if (!wallSec)
     {
-        logBufferRuntime[logHead] = msg[i];
-        logHead = (logHead + 1) % LOG_BUFFER_SIZE;
+        snprintf(out, n, "+%lu.%03u", (unsigned long)(us / 1000000), (unsigned)((us / 1000) % 1000));
+        return;
     }
+    if (wallSec != cache.sec)
+    {
+        time_t t = wallSec;
+        struct tm tmv;
+        localtime_r(&t, &tmv);
+        strftime(cache.text, sizeof(cache.text), "%Y-%m-%d %H:%M:%S", &tmv);
+        cache.sec = wallSec;
+    }
+    snprintf(out, n, "%s.%03u", cache.text, (unsigned)wallMs);
+}
 
-    // Append newline and move head
-    logBufferRuntime[logHead] = '\n';
-    logHead = (logHead + 1) % LOG_BUFFER_SIZE;
+static size_t formatRecord(StampCache &cache, const LogRecord &rec, const char *text, char *out, size_t n)
+{
+    if (!rec.level)
+        return snprintf(out, n, "%.*s", (int)rec.len, text);
+
+    char stamp[32];
+    formatStamp(cache, stamp, sizeof(stamp), rec.wallSec, rec.wallMs, rec.us);
+    return snprintf(out, n, "[%c][%s] %.*s", rec.level, stamp, (int)rec.len, text);
+}
+
+// ==========================================================
+// 📜 Raw lines (console echo) into the log stores
+// ==========================================================
+void addLog(const char *msg)
+{
+    LogLock lock;
+    storeRecord(makeRecord(0, strlen(msg)), msg);
 }
 
 // Overload for String
@@ -47,46 +170,81 @@ void addLog(const String &msg)
 // ==========================================================
 void logMessage(const char *level, const char *fmt, ...)
 {
+    PROFILE_SCOPE("logMessage");
     static char buf[256];
+    static char line[300];
+    static StampCache serialStamp;
+
+    LogLock lock;
     va_list args;
     va_start(args, fmt);
-    vsnprintf(buf, sizeof(buf), fmt, args);
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
+    len = constrain(len, 0, (int)sizeof(buf) - 1);
 
-    // Get timestamp (NTP or millis)
-    String ts = getDateTime();
-    if (ts == "N/A" || ts.length() < 5)
-    {
-        ts = String(ts_ms());
-    }
-
-    // Compose final log line
-    String msg = "[" + String(level) + "][" + ts + "] " + buf;
+    LogRecord rec = makeRecord(level[0], len);
+    formatRecord(serialStamp, rec, buf, line, sizeof(line));
 
     // Output to serial
-    Serial.println(msg);
+    Serial.println(line);
+
+    // Store the raw record; formatted again only when shown
+    storeRecord(rec, buf);
+}
 
-    // Store in appropriate buffer
-    if (millis() < 10000) // Boot logs (first 10s)
-        addLogSetup(msg);
-    else
-        addLog(msg.c_str());
+// ==========================================================
+// 🧹 Clear both stores
+// ==========================================================
+void clearLog()
+{
+    LogLock lock;
+    setupUsed = 0;
+    setupDropped = 0;
+    runHead = runTail = runUsed = 0;
 }
 
 // ==========================================================
-// 📋 Retrieve entire log buffer as String
+// 📋 Retrieve entire log as String (formatted here)
 // ==========================================================
 String getLog()
 {
-    String out = logBufferSetup + "\n--- Live Runtime ---\n";
+    StampCache cache;
+    char line[300];
+    char text[256];
+    String out;
 
-    size_t idx = logHead;
-    for (size_t i = 0; i < LOG_BUFFER_SIZE; i++)
+    LogLock lock;
+    out.reserve(setupUsed + runUsed + 512);
+
+    for (size_t pos = 0; pos < setupUsed;)
+    {
+        LogRecord rec;
+        memcpy(&rec, logSetup + pos, sizeof(rec));
+        formatRecord(cache, rec, (const char *)logSetup + pos + sizeof(rec), line, sizeof(line));
+        out += line;
+        out += '\n';
+        pos += sizeof(rec) + rec.len;
+    }
+    if (setupDropped)
+        out += "(" + String(setupDropped) + " boot lines dropped)\n";
+
+    out += "\n--- Live Runtime ---\n";
+
+    for (size_t pos = runTail, left = runUsed; left;)
     {
-        char c = logBufferRuntime[idx];
-        if (c != 0)
-            out += c;
-        idx = (idx + 1) % LOG_BUFFER_SIZE;
+        LogRecord rec;
+        ringRead(pos, &rec, sizeof(rec));
+        size_t n = min<size_t>(rec.len, sizeof(text));
+        ringRead((pos + sizeof(rec)) % LOG_BUFFER_SIZE, text, n);
+        LogRecord shown = rec;
+        shown.len = n;
+        formatRecord(cache, shown, text, line, sizeof(line));
+        out += line;
+        out += '\n';
+
+        size_t sz = sizeof(rec) + rec.len;
+        pos = (pos + sz) % LOG_BUFFER_SIZE;
+        left -= sz;
     }
 
     return out;
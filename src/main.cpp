@@ -28,6 +28,7 @@ void setup()
         g_settings.pwm_freq_hz,
         g_settings.pwm_resolution_bits,
         g_settings.invert_pwm);
+    fanTachInit();
     initADC();
     LOGI("ADC init OK");
 
@@ -57,9 +58,6 @@ void setup()
          WiFi.isConnected() ? "true" : "false",
          WiFi.SSID().c_str(), WiFi.localIP().toString().c_str(), WiFi.RSSI());
 
-    // --- NTP time ---
-    initTime("pool.ntp.org", 0, 3600);
-
     // --- Sensors & peripherals ---
     initDallas();
     LOGI("Dallas init OK");
@@ -99,6 +97,10 @@ void setup()
     // --- Create tasks ---
     BaseType_t ok;
 
+    ok = xTaskCreatePinnedToCore(taskTimers, "Timers", 4096, nullptr, 3, &hTimers, 0);
+    LOGI("taskTimers %s", ok == pdPASS ? "OK" : "FAIL");
+    heapTrendInit();
+
     ok = xTaskCreatePinnedToCore(taskSensors, "Sensors", 3072, nullptr, 2, &hSensors, 0);
     LOGI("taskSensors %s", ok == pdPASS ? "OK" : "FAIL");
 
@@ -108,6 +110,13 @@ void setup()
     ok = xTaskCreatePinnedToCore(taskCan, "CAN", 2048, nullptr, 1, &hCan, 1);
     LOGI("taskCan %s", ok == pdPASS ? "OK" : "FAIL");
 
+    ok = xTaskCreatePinnedToCore(taskOtaPull, "OtaPull", 8192, nullptr, tskIDLE_PRIORITY + 1, &hOtaPull, 0);
+    LOGI("taskOtaPull %s", ok == pdPASS ? "OK" : "FAIL");
+
+    taskMonitorInit();
+    ok = xTaskCreatePinnedToCore(taskMonitor, "TaskMon", 3072, nullptr, tskIDLE_PRIORITY + 1, &hMonitor, 0);
+    LOGI("taskMonitor %s", ok == pdPASS ? "OK" : "FAIL");
+
     // --- Web server ---
     initServer();
     LOGI("[HTTP] Server started");
@@ -121,5 +130,6 @@ void setup()
 void loop()
 {
     processSerialCommands();
+    timeService();
     vTaskDelay(pdMS_TO_TICKS(50)); // cooperative delay for FreeRTOS
 }
@@ -0,0 +1,361 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <memory>
+#include "project_config.h"
+
+// ==========================================================
+// 🧩 Registry
+// ==========================================================
+static Metric *metricHead = nullptr;
+
+Metric::Metric(const char *n, const char *h, const char *l, MetricType t)
+    : name(n), help(h), labels(l), type(t), next(nullptr)
+{
+  // Static constructors run on one core before the scheduler
+  // starts, so a plain push is enough. Keep registration order.
+  Metric **tail = &metricHead;
+  while (*tail)
+    tail = &(*tail)->next;
+  *tail = this;
+}
+
+Metric *Metric::head()
+{
+  return metricHead;
+}
+
+uint32_t MetricCounter::value() const
+{
+  if (read_)
+    return read_();
+  uint32_t sum = 0;
+  for (int c = 0; c < portNUM_PROCESSORS; c++)
+    sum += __atomic_load_n(&shards_[c], __ATOMIC_RELAXED);
+  return sum;
+}
+
+float MetricGauge::value() const
+{
+  if (read_)
+    return read_();
+  uint32_t bits = __atomic_load_n(&bits_, __ATOMIC_RELAXED);
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+MetricHistogram::MetricHistogram(const char *n, const char *h, const float *b, uint8_t count, const char *l)
+    : Metric(n, h, l, MetricType::HISTOGRAM), bounds(b), boundCount(min<uint8_t>(count, METRIC_HIST_MAX_BOUNDS))
+{
+}
+
+void MetricHistogram::observe(float v)
+{
+  int core = xPortGetCoreID();
+  uint8_t b = 0;
+  while (b < boundCount && v > bounds[b])
+    b++;
+  __atomic_fetch_add(&buckets_[core][b], 1, __ATOMIC_RELAXED);
+
+  // Float add on this core's shard; retry if preempted mid-update
+  uint32_t seen = __atomic_load_n(&sumBits_[core], __ATOMIC_RELAXED);
+  for (;;)
+  {
+    float sum;
+    memcpy(&sum, &seen, sizeof(sum));
+    sum += v;
+    uint32_t bits;
+    memcpy(&bits, &sum, sizeof(bits));
+    if (__atomic_compare_exchange_n(&sumBits_[core], &seen, bits, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      break;
+  }
+}
+
+void MetricHistogram::snapshot(uint32_t *cumulative, float &sum) const
+{
+  sum = 0;
+  uint32_t running = 0;
+  for (uint8_t b = 0; b <= boundCount; b++)
+  {
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+      running += __atomic_load_n(&buckets_[c][b], __ATOMIC_RELAXED);
+    cumulative[b] = running;
+  }
+  for (int c = 0; c < portNUM_PROCESSORS; c++)
+  {
+    uint32_t bits = __atomic_load_n(&sumBits_[c], __ATOMIC_RELAXED);
+    float v;
+    memcpy(&v, &bits, sizeof(v));
+    sum += v;
+  }
+}
+
+// ==========================================================
+// 🌡️ System metrics (read at scrape time)
+// ==========================================================
+static MetricGauge mEngineTemp("engine_temperature_celsius", "Engine temperature (DS18B20), NaN when disconnected",
+                               []() -> float { return sensorData.engineC; });
+static MetricGauge mSystemTemp("system_temperature_celsius", "Controller board temperature (NTC)",
+                               []() -> float { return sensorData.systemC; });
+static MetricGauge mFanDuty("fan_duty_percent", "Commanded fan duty",
+                            []() -> float { return sensorData.targetPercent; });
+static MetricGauge mFanPwm("fan_pwm", "Raw PWM compare value written to LEDC",
+                           []() -> float { return sensorData.target_pwm; });
+static MetricGauge mHeapFree("heap_free_bytes", "Free heap",
+                             []() -> float { return ESP.getFreeHeap(); });
+static MetricGauge mHeapMin("heap_min_free_bytes", "Lowest free heap since boot",
+                            []() -> float { return ESP.getMinFreeHeap(); });
+static MetricGauge mHeapBlock("heap_largest_block_bytes", "Largest allocatable heap block",
+                              []() -> float { return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); });
+static MetricGauge mRssi("wifi_rssi_dbm", "Wi-Fi signal strength, NaN when disconnected",
+                         []() -> float { return WiFi.isConnected() ? WiFi.RSSI() : NAN; });
+static MetricGauge mUptime("uptime_seconds", "Time since boot",
+                           []() -> float { return mono_ms() / 1000.0f; });
+
+// ==========================================================
+// 📝 OpenMetrics rendering, one line per step
+// ----------------------------------------------------------
+// The cursor walks families (first metric of each name), then
+// the members of that family. Lines are produced into a small
+// buffer and copied out as the chunked response asks for
+// bytes, so the body never exists as a whole.
+// ==========================================================
+enum class CursorState : uint8_t
+{
+  START,
+  HELP,
+  TYPE,
+  SAMPLES,
+  END,
+  DONE
+};
+
+struct MetricsCursor
+{
+  CursorState state = CursorState::START;
+  Metric *family = nullptr;
+  Metric *member = nullptr;
+  int sub = 0;   // Line index inside the member
+  uint32_t cumulative[METRIC_HIST_MAX_BOUNDS + 1];
+  float sum = 0;
+  char line[224];
+  size_t len = 0;
+  size_t off = 0;
+};
+
+static bool startsFamily(Metric *m)
+{
+  for (Metric *p = Metric::head(); p != m; p = p->next)
+    if (!strcmp(p->name, m->name))
+      return false;
+  return true;
+}
+
+static Metric *nextFamily(Metric *from)
+{
+  for (Metric *m = from; m; m = m->next)
+    if (startsFamily(m))
+      return m;
+  return nullptr;
+}
+
+static Metric *nextMember(Metric *family, Metric *after)
+{
+  for (Metric *m = after->next; m; m = m->next)
+    if (!strcmp(m->name, family->name))
+      return m;
+  return nullptr;
+}
+
+static const char *typeName(MetricType t)
+{
+  switch (t)
+  {
+  case MetricType::COUNTER: return "counter";
+  case MetricType::HISTOGRAM: return "histogram";
+  default: return "gauge";
+  }
+}
+
+static void formatValue(char *out, size_t n, float v)
+{
+  if (isnan(v))
+    strlcpy(out, "NaN", n);
+  else if (isinf(v))
+    strlcpy(out, v > 0 ? "+Inf" : "-Inf", n);
+  else
+    snprintf(out, n, "%.7g", v);
+}
+
+// `{a="1",le="0.5"}` from the metric's labels plus one extra pair
+static void formatLabels(char *out, size_t n, const char *labels, const char *extra)
+{
+  bool a = labels && *labels;
+  bool b = extra && *extra;
+  if (!a && !b)
+    *out = 0;
+  else
+    snprintf(out, n, "{%s%s%s}", a ? labels : "", a && b ? "," : "", b ? extra : "");
+}
+
+// One sample line of the current member; false when the member is done
+static bool sampleLine(MetricsCursor &c)
+{
+  Metric *m = c.member;
+  char lbl[96], val[24];
+
+  if (m->collect)
+  {
+    char own[64] = "";
+    float v;
+    if (!m->collect(c.sub, own, sizeof(own), v))
+      return false;
+    formatLabels(lbl, sizeof(lbl), own, nullptr);
+    formatValue(val, sizeof(val), v);
+    c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s%s%s %s\n", m->name,
+                     m->type == MetricType::COUNTER ? "_total" : "", lbl, val);
+    return true;
+  }
+
+  switch (m->type)
+  {
+  case MetricType::COUNTER:
+    if (c.sub)
+      return false;
+    formatLabels(lbl, sizeof(lbl), m->labels, nullptr);
+    c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s_total%s %lu\n", m->name, lbl,
+                     (unsigned long)static_cast<MetricCounter *>(m)->value());
+    return true;
+
+  case MetricType::GAUGE:
+    if (c.sub)
+      return false;
+    formatLabels(lbl, sizeof(lbl), m->labels, nullptr);
+    formatValue(val, sizeof(val), static_cast<MetricGauge *>(m)->value());
+    c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s%s %s\n", m->name, lbl, val);
+    return true;
+
+  case MetricType::HISTOGRAM:
+  {
+    auto *h = static_cast<MetricHistogram *>(m);
+    if (c.sub == 0)
+      h->snapshot(c.cumulative, c.sum);   // Buckets, count and sum from one read
+
+    int n = h->boundCount;
+    if (c.sub <= n)
+    {
+      char le[32];
+      if (c.sub < n)
+      {
+        formatValue(val, sizeof(val), h->bounds[c.sub]);
+        snprintf(le, sizeof(le), "le=\"%s\"", val);
+      }
+      else
+        strlcpy(le, "le=\"+Inf\"", sizeof(le));
+      formatLabels(lbl, sizeof(lbl), m->labels, le);
+      c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s_bucket%s %lu\n", m->name, lbl,
+                       (unsigned long)c.cumulative[c.sub]);
+      return true;
+    }
+    formatLabels(lbl, sizeof(lbl), m->labels, nullptr);
+    if (c.sub == n + 1)
+    {
+      c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s_count%s %lu\n", m->name, lbl,
+                       (unsigned long)c.cumulative[n]);
+      return true;
+    }
+    if (c.sub == n + 2)
+    {
+      formatValue(val, sizeof(val), c.sum);
+      c.len = snprintf(c.line, sizeof(c.line), METRICS_PREFIX "%s_sum%s %s\n", m->name, lbl, val);
+      return true;
+    }
+    return false;
+  }
+  }
+  return false;
+}
+
+// Produce the next line into c.line; false at the end
+static bool nextLine(MetricsCursor &c)
+{
+  for (;;)
+  {
+    switch (c.state)
+    {
+    case CursorState::START:
+      c.family = nextFamily(Metric::head());
+      c.state = c.family ? CursorState::HELP : CursorState::END;
+      break;
+
+    case CursorState::HELP:
+      c.len = snprintf(c.line, sizeof(c.line), "# HELP " METRICS_PREFIX "%s %s\n", c.family->name, c.family->help);
+      c.state = CursorState::TYPE;
+      return true;
+
+    case CursorState::TYPE:
+      c.len = snprintf(c.line, sizeof(c.line), "# TYPE " METRICS_PREFIX "%s %s\n", c.family->name, typeName(c.family->type));
+      c.member = c.family;
+      c.sub = 0;
+      c.state = CursorState::SAMPLES;
+      return true;
+
+    case CursorState::SAMPLES:
+      if (!c.member)
+      {
+        c.family = nextFamily(c.family->next);
+        c.state = c.family ? CursorState::HELP : CursorState::END;
+        break;
+      }
+      if (sampleLine(c))
+      {
+        c.sub++;
+        return true;
+      }
+      c.member = nextMember(c.family, c.member);
+      c.sub = 0;
+      break;
+
+    case CursorState::END:
+      c.len = snprintf(c.line, sizeof(c.line), "# EOF\n");
+      c.state = CursorState::DONE;
+      return true;
+
+    case CursorState::DONE:
+      return false;
+    }
+  }
+}
+
+// ==========================================================
+// 📤 GET /metrics
+// ==========================================================
+void handleMetrics(AsyncWebServerRequest *request)
+{
+  // Freed with the response once the last chunk is sent
+  auto cursor = std::make_shared<MetricsCursor>();
+
+  AsyncWebServerResponse *res = request->beginChunkedResponse(
+      "application/openmetrics-text; version=1.0.0; charset=utf-8",
+      [cursor](uint8_t *buf, size_t maxLen, size_t) -> size_t
+      {
+        MetricsCursor &c = *cursor;
+        size_t out = 0;
+        while (out < maxLen)
+        {
+          if (c.off == c.len)
+          {
+            c.off = c.len = 0;
+            if (!nextLine(c))
+              break;
+            c.len = min(c.len, sizeof(c.line) - 1);   // snprintf may report more than it wrote
+          }
+          size_t n = min(c.len - c.off, maxLen - out);
+          memcpy(buf + out, c.line + c.off, n);
+          c.off += n;
+          out += n;
+        }
+        return out;
+      });
+  request->send(res);
+}
@@ -0,0 +1,344 @@
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Update.h>
+#include "project_config.h"
+#include "inflate_stream.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "mbedtls/sha256.h"
+
+// ============================================================
+// 🧬 Delta OTA (EDLT v1 patches from delta_ota.py)
+// ------------------------------------------------------------
+//   upload → [80-byte header] → inflate → records → otaWrite()
+//
+// Each record copies `diff_len` bytes from the running partition
+// with a byte-wise add, then `extra_len` literal bytes, then seeks
+// in the source. The result streams through the regular OTA
+// pipeline, which checks it against the new-image SHA-256 from
+// the patch header before committing. The upload request owns
+// both the delta session and the OTA session it opens.
+//
+// The digest of the running image is computed once after boot
+// (deltaHashRunning, from the low-priority OtaPull task), so the
+// upload callback only compares 32 bytes.
+// ============================================================
+
+#define DELTA_HEADER_SIZE 80
+#define DELTA_CTRL_SIZE 12
+#define DELTA_VERSION 1
+
+enum class DeltaPhase : uint8_t
+{
+  HEADER,
+  CTRL,
+  DIFF,
+  EXTRA,
+  DONE,
+  FAILED
+};
+
+struct DeltaSession
+{
+  DeltaPhase phase = DeltaPhase::HEADER;
+  uint8_t header[DELTA_HEADER_SIZE];
+  size_t headerFill = 0;
+  uint8_t ctrl[DELTA_CTRL_SIZE];
+  size_t ctrlFill = 0;
+
+  uint32_t diffLeft = 0;
+  uint32_t extraLeft = 0;
+  int32_t seek = 0;
+  int64_t oldPos = 0;
+
+  uint32_t oldSize = 0;
+  uint32_t newSize = 0;
+  uint32_t produced = 0;
+  uint32_t received = 0;
+  uint32_t tStart = 0;
+  const esp_partition_t *source = nullptr;
+  AsyncWebServerRequest *owner = nullptr;
+};
+
+static DeltaSession delta;
+static InflateStream inflater;
+static uint8_t oldBuf[1024];
+
+static uint8_t runningSha[32];
+static uint32_t runningSize = 0;
+static volatile bool runningHashed = false;
+
+static uint32_t rd32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void deltaFail(const char *reason)
+{
+  if (delta.phase == DeltaPhase::FAILED)
+    return;
+  delta.phase = DeltaPhase::FAILED;
+  inflater.end();
+  otaAbort(delta.owner, reason);
+}
+
+static bool deltaActive()
+{
+  return delta.owner && delta.phase != DeltaPhase::DONE && delta.phase != DeltaPhase::FAILED;
+}
+
+static void deltaRelease(AsyncWebServerRequest *request)
+{
+  if (delta.owner != request)
+    return;
+  if (deltaActive())
+  {
+    delta.phase = DeltaPhase::FAILED;
+    inflater.end();
+  }
+  delta.owner = nullptr;
+  otaRelease(request);
+}
+
+// Read source bytes; anything outside the old image reads as 0
+static void readOld(int64_t pos, uint8_t *buf, size_t n)
+{
+  memset(buf, 0, n);
+  int64_t from = max<int64_t>(pos, 0);
+  int64_t to = min<int64_t>(pos + n, delta.oldSize);
+  if (from < to)
+    esp_partition_read(delta.source, (size_t)from, buf + (from - pos), (size_t)(to - from));
+}
+
+// Hashes the running image (its size from the image header
+// walk). Takes a few hundred ms; yields between flash reads.
+void deltaHashRunning()
+{
+  const esp_partition_t *part = esp_ota_get_running_partition();
+  uint32_t size = ESP.getSketchSize();
+  if (!part || !size || size > part->size)
+    return;
+
+  uint8_t buf[512];
+  mbedtls_sha256_context sha;
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  for (uint32_t off = 0; off < size; off += sizeof(buf))
+  {
+    size_t n = min<uint32_t>(sizeof(buf), size - off);
+    esp_partition_read(part, off, buf, n);
+    mbedtls_sha256_update(&sha, buf, n);
+    if (!(off & 0xFFFF))
+      vTaskDelay(1);
+  }
+  mbedtls_sha256_finish(&sha, runningSha);
+  mbedtls_sha256_free(&sha);
+  runningSize = size;
+  runningHashed = true;
+  LOGI("[DELTA] Running image: %u bytes hashed", (unsigned)size);
+}
+
+static bool sourceMatches(const uint8_t expected[32], uint32_t size)
+{
+  return size == runningSize && memcmp(runningSha, expected, sizeof(runningSha)) == 0;
+}
+
+static void endRecord()
+{
+  delta.oldPos += delta.seek;
+  delta.ctrlFill = 0;
+  delta.phase = delta.produced >= delta.newSize ? DeltaPhase::DONE : DeltaPhase::CTRL;
+}
+
+// ============================================================
+// 🧩 Record decoder (inflate sink)
+// ============================================================
+static bool onPatchBytes(const uint8_t *p, size_t len, void *)
+{
+  while (len)
+  {
+    switch (delta.phase)
+    {
+    case DeltaPhase::CTRL:
+    {
+      size_t n = min(len, DELTA_CTRL_SIZE - delta.ctrlFill);
+      memcpy(delta.ctrl + delta.ctrlFill, p, n);
+      delta.ctrlFill += n;
+      p += n;
+      len -= n;
+      if (delta.ctrlFill < DELTA_CTRL_SIZE)
+        break;
+
+      delta.diffLeft = rd32(delta.ctrl);
+      delta.extraLeft = rd32(delta.ctrl + 4);
+      delta.seek = (int32_t)rd32(delta.ctrl + 8);
+      if ((uint64_t)delta.produced + delta.diffLeft + delta.extraLeft > delta.newSize)
+      {
+        deltaFail("Patch record runs past the new image size");
+        return false;
+      }
+      if (delta.diffLeft)
+        delta.phase = DeltaPhase::DIFF;
+      else if (delta.extraLeft)
+        delta.phase = DeltaPhase::EXTRA;
+      else
+        endRecord();
+      break;
+    }
+
+    case DeltaPhase::DIFF:
+    {
+      size_t n = min(min(len, (size_t)delta.diffLeft), sizeof(oldBuf));
+      readOld(delta.oldPos, oldBuf, n);
+      for (size_t i = 0; i < n; i++)
+        oldBuf[i] += p[i];
+      if (!otaWrite(delta.owner, oldBuf, n))
+      {
+        deltaFail(otaError());
+        return false;
+      }
+      delta.oldPos += n;
+      delta.diffLeft -= n;
+      delta.produced += n;
+      p += n;
+      len -= n;
+      if (!delta.diffLeft)
+      {
+        if (delta.extraLeft)
+          delta.phase = DeltaPhase::EXTRA;
+        else
+          endRecord();
+      }
+      break;
+    }
+
+    case DeltaPhase::EXTRA:
+    {
+      size_t n = min(len, (size_t)delta.extraLeft);
+      if (!otaWrite(delta.owner, p, n))
+      {
+        deltaFail(otaError());
+        return false;
+      }
+      delta.extraLeft -= n;
+      delta.produced += n;
+      p += n;
+      len -= n;
+      if (!delta.extraLeft)
+        endRecord();
+      break;
+    }
+
+    case DeltaPhase::DONE:
+      return true; // Trailing bytes after the last record are ignored
+
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+// ============================================================
+// 📜 Header: check the source image, then open the pipeline
+// ============================================================
+static bool startFromHeader()
+{
+  const uint8_t *h = delta.header;
+  if (memcmp(h, "EDLT", 4) != 0 || h[4] != DELTA_VERSION)
+  {
+    deltaFail("Not an EDLT v1 delta patch");
+    return false;
+  }
+
+  delta.oldSize = rd32(h + 8);
+  delta.newSize = rd32(h + 12);
+  delta.source = esp_ota_get_running_partition();
+
+  if (!runningHashed)
+  {
+    deltaFail("Running firmware not hashed yet, retry in a few seconds");
+    return false;
+  }
+  if (!sourceMatches(h + 16, delta.oldSize))
+  {
+    deltaFail("Patch does not match the running firmware");
+    return false;
+  }
+
+  char newSha[65];
+  for (int i = 0; i < 32; i++)
+    snprintf(newSha + 2 * i, 3, "%02x", h[48 + i]);
+
+  if (!otaBegin(delta.owner, U_FLASH, delta.newSize, newSha))
+  {
+    delta.phase = DeltaPhase::FAILED;
+    return false;
+  }
+  if (!inflater.begin(InflateStream::ZLIB))
+  {
+    deltaFail("Not enough memory for the decompressor");
+    return false;
+  }
+
+  LOGI("[DELTA] Source %s OK, %u → %u bytes",
+       delta.source->label, (unsigned)delta.oldSize, (unsigned)delta.newSize);
+  delta.phase = delta.newSize ? DeltaPhase::CTRL : DeltaPhase::DONE;
+  return true;
+}
+
+// ============================================================
+// 🌐 Upload handler (/firmware_delta)
+// ============================================================
+void handleUpdateDelta(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+{
+  if (!index && !deltaActive() && !otaInProgress() && !otaPullBusy())
+  {
+    delta = DeltaSession();
+    delta.owner = request;
+    delta.tStart = millis();
+    currentOTAProgress = 0;
+    totalOTABytes = request->contentLength();
+    routeStatsOnDisconnect(request, [request]() { deltaRelease(request); });
+  }
+  // Another update holds the pipeline: otaUploadDone answers 409
+  if (delta.owner != request)
+    return;
+
+  currentOTAProgress = index + len;
+  delta.received += len;
+
+  if (delta.phase == DeltaPhase::HEADER)
+  {
+    size_t n = min(len, DELTA_HEADER_SIZE - delta.headerFill);
+    memcpy(delta.header + delta.headerFill, data, n);
+    delta.headerFill += n;
+    data += n;
+    len -= n;
+    if (delta.headerFill == DELTA_HEADER_SIZE)
+      startFromHeader();
+  }
+
+  if (len && delta.phase != DeltaPhase::HEADER && delta.phase != DeltaPhase::FAILED)
+  {
+    if (!inflater.feed(data, len, onPatchBytes, nullptr))
+      deltaFail(delta.phase == DeltaPhase::FAILED ? otaError() : "Corrupt delta stream");
+  }
+
+  if (!final)
+    return;
+
+  if (delta.phase == DeltaPhase::DONE)
+  {
+    inflater.end();
+    if (otaEnd(request))
+      LOGI("[DELTA] Applied: %u patch bytes → %u image bytes (%.1f%%) in %lu ms",
+           (unsigned)delta.received, (unsigned)delta.produced,
+           delta.produced ? 100.0f * delta.received / delta.produced : 0.0f,
+           (unsigned long)(millis() - delta.tStart));
+  }
+  else if (delta.phase != DeltaPhase::FAILED)
+  {
+    deltaFail("Patch ended before the new image was complete");
+  }
+}
@@ -0,0 +1,353 @@
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <Update.h>
+#include "project_config.h"
+
+// ============================================================
+// 📥 Background OTA (pull from g_settings.ota_url)
+// ------------------------------------------------------------
+// ota_url points at a JSON manifest:
+//   { "version": 14, "url": "firmware.bin",
+//     "size": 1234567, "sha256": "<64 hex chars>" }
+// "url" may be absolute or relative to the manifest.
+//
+// When "version" is newer than buildNumber the image is
+// streamed into the OTA pipeline. Dropped connections resume
+// with an HTTP Range request. The SHA-256 is mandatory: the
+// image is only committed if it matches. The reboot waits for
+// a safe moment (fan duty low, no temperature alert).
+//
+// Runs at the lowest task priority on core 0, away from
+// taskControl (core 1), and yields between network reads.
+// It owns the OTA session while downloading; HTTP uploads are
+// refused while it is busy and a check waits for a running
+// upload to finish.
+// ============================================================
+
+#ifndef OTA_PULL_INTERVAL_MS
+#define OTA_PULL_INTERVAL_MS (6UL * 60 * 60 * 1000)   // Manifest check period
+#endif
+#ifndef OTA_PULL_FIRST_DELAY_MS
+#define OTA_PULL_FIRST_DELAY_MS (60UL * 1000)         // Let boot settle first
+#endif
+#ifndef OTA_PULL_RETRIES
+#define OTA_PULL_RETRIES 5                            // Resume attempts per download
+#endif
+#ifndef OTA_SAFE_DUTY_PCT
+#define OTA_SAFE_DUTY_PCT 30                          // Reboot only below this fan duty
+#endif
+
+extern int buildNumber;
+
+enum class PullState : uint8_t
+{
+  IDLE,
+  CHECKING,
+  DOWNLOADING,
+  WAIT_REBOOT,
+  FAILED
+};
+
+struct OtaManifest
+{
+  int version = 0;
+  String url;
+  size_t size = 0;
+  String sha256;
+};
+
+static struct
+{
+  PullState state = PullState::IDLE;
+  uint32_t lastCheck = 0;
+  int remoteVersion = 0;
+  size_t downloaded = 0;
+  size_t total = 0;
+  uint8_t resumes = 0;
+  bool forced = false;
+  char error[96] = "";
+} pull;
+
+static uint8_t pullBuf[1024];   // Task-owned; keeps the stack small
+
+__attribute__((format(printf, 1, 2)))
+static void pullFail(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(pull.error, sizeof(pull.error), fmt, args);
+  va_end(args);
+  pull.state = PullState::FAILED;
+  LOGE("[OTA-PULL] %s", pull.error);
+}
+
+// ============================================================
+// 🧩 Helpers
+// ============================================================
+static String resolveUrl(const String &base, const String &ref)
+{
+  if (ref.startsWith("http://") || ref.startsWith("https://"))
+    return ref;
+
+  if (ref.startsWith("/"))
+  {
+    int host = base.indexOf("://");
+    int path = base.indexOf('/', host < 0 ? 0 : host + 3);
+    return (path < 0 ? base : base.substring(0, path)) + ref;
+  }
+  return base.substring(0, base.lastIndexOf('/') + 1) + ref;
+}
+
+static bool fetchManifest(OtaManifest &m)
+{
+  HTTPClient http;
+  http.setTimeout(10000);
+  if (!http.begin(g_settings.ota_url))
+  {
+    pullFail("Bad manifest URL: %s", g_settings.ota_url.c_str());
+    return false;
+  }
+
+  int code = http.GET();
+  if (code != HTTP_CODE_OK)
+  {
+    pullFail("Manifest GET failed: %d %s", code, code < 0 ? http.errorToString(code).c_str() : "");
+    http.end();
+    return false;
+  }
+
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
+  DeserializationError err = deserializeJson(doc, http.getStream());
+  http.end();
+  if (err)
+  {
+    pullFail("Manifest parse error: %s", err.c_str());
+    return false;
+  }
+
+  m.version = doc["version"] | 0;
+  m.url = resolveUrl(g_settings.ota_url, doc["url"] | "firmware.bin");
+  m.size = doc["size"] | 0;
+  m.sha256 = doc["sha256"] | "";
+
+  if (!m.size || m.sha256.length() != 64)
+  {
+    pullFail("Manifest needs \"size\" and a 64-char \"sha256\"");
+    return false;
+  }
+  return true;
+}
+
+// ============================================================
+// ⬇️ Download with Range resume
+// ============================================================
+static bool downloadImage(const OtaManifest &m)
+{
+  if (!otaBegin(&pull, U_FLASH, m.size, m.sha256.c_str()))
+  {
+    pullFail("OTA pipeline busy or rejected: %s", otaError());
+    return false;
+  }
+
+  pull.state = PullState::DOWNLOADING;
+  pull.downloaded = 0;
+  pull.total = m.size;
+  pull.resumes = 0;
+
+  size_t written = 0;
+  for (int attempt = 0; written < m.size && attempt <= OTA_PULL_RETRIES; attempt++)
+  {
+    if (attempt)
+    {
+      pull.resumes++;
+      LOGW("[OTA-PULL] Resuming at %u/%u (attempt %d)", (unsigned)written, (unsigned)m.size, attempt);
+      vTaskDelay(pdMS_TO_TICKS(2000 * attempt));
+    }
+    if (!WiFi.isConnected())
+      continue;
+
+    HTTPClient http;
+    http.setTimeout(15000);
+    if (!http.begin(m.url))
+      break;
+    if (written)
+      http.addHeader("Range", "bytes=" + String(written) + "-");
+
+    int code = http.GET();
+    size_t skip = 0;
+    if (code == HTTP_CODE_OK && written)
+      skip = written;   // Server ignored the Range header: drop what we already have
+    else if (code != HTTP_CODE_OK && code != HTTP_CODE_PARTIAL_CONTENT)
+    {
+      LOGW("[OTA-PULL] Image GET failed: %d", code);
+      http.end();
+      continue;
+    }
+
+    WiFiClient *stream = http.getStreamPtr();
+    uint32_t lastData = millis();
+    while (written < m.size && (http.connected() || stream->available()))
+    {
+      size_t avail = stream->available();
+      if (!avail)
+      {
+        if (millis() - lastData > 10000)
+          break;
+        vTaskDelay(pdMS_TO_TICKS(5));
+        continue;
+      }
+
+      int n = stream->readBytes(pullBuf, min(avail, sizeof(pullBuf)));
+      if (n <= 0)
+        break;
+      lastData = millis();
+
+      size_t off = min(skip, (size_t)n);
+      skip -= off;
+      size_t take = min((size_t)n - off, m.size - written);
+      if (take && !otaWrite(&pull, pullBuf + off, take))
+      {
+        http.end();
+        pullFail("Write failed: %s", otaError());
+        return false;
+      }
+      written += take;
+      pull.downloaded = written;
+      vTaskDelay(1);   // Leave the CPU to anything else that wants it
+    }
+    http.end();
+  }
+
+  if (written < m.size)
+  {
+    otaAbort(&pull, "Background download incomplete");
+    pullFail("Download incomplete (%u/%u bytes after %u resumes)",
+             (unsigned)written, (unsigned)m.size, pull.resumes);
+    return false;
+  }
+  if (!otaEnd(&pull))
+  {
+    pullFail("Image rejected: %s", otaError());
+    return false;
+  }
+  return true;
+}
+
+static void checkForUpdate()
+{
+  pull.state = PullState::CHECKING;
+  pull.lastCheck = millis();
+  pull.error[0] = 0;
+
+  OtaManifest m;
+  if (!fetchManifest(m))
+    return;
+
+  pull.remoteVersion = m.version;
+  if (m.version <= buildNumber)
+  {
+    LOGI("[OTA-PULL] Up to date (running %d, manifest %d)", buildNumber, m.version);
+    pull.state = PullState::IDLE;
+    return;
+  }
+
+  LOGI("[OTA-PULL] Update %d → %d from %s (%u bytes)", buildNumber, m.version, m.url.c_str(), (unsigned)m.size);
+  if (downloadImage(m))
+  {
+    pull.state = PullState::WAIT_REBOOT;
+    LOGI("[OTA-PULL] Image verified, waiting for a safe moment to reboot");
+  }
+}
+
+static bool safeToReboot()
+{
+  return sensorData.targetPercent <= OTA_SAFE_DUTY_PCT &&
+         sensorData.systemC < g_settings.system_temp_alert &&
+         !otaInProgress();
+}
+
+// ============================================================
+// 🔁 Task
+// ============================================================
+void taskOtaPull(void *)
+{
+  deltaHashRunning();   // Delta uploads compare against this digest
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OTA_PULL_FIRST_DELAY_MS));
+
+  for (;;)
+  {
+    if (pull.state == PullState::WAIT_REBOOT)
+    {
+      // The new image is already the boot partition; a power cycle
+      // would also pick it up, so there is no deadline here.
+      if (safeToReboot())
+      {
+        LOGI("[OTA-PULL] Fan at %.0f%%, rebooting into the new firmware", sensorData.targetPercent);
+        scheduleRestart(1000);
+        vTaskSuspend(nullptr);
+      }
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+
+    bool wanted = (g_settings.ota_enabled || pull.forced) && g_settings.ota_url.length();
+    if (wanted && otaInProgress())
+    {
+      LOGI("[OTA-PULL] Upload in progress, check postponed");
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OTA_PULL_FIRST_DELAY_MS));
+      continue;
+    }
+    pull.forced = false;
+    if (wanted && WiFi.isConnected())
+      checkForUpdate();
+
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(OTA_PULL_INTERVAL_MS));
+  }
+}
+
+// Checking, downloading or holding a verified image for the reboot
+bool otaPullBusy()
+{
+  return pull.state == PullState::CHECKING || pull.state == PullState::DOWNLOADING ||
+         pull.state == PullState::WAIT_REBOOT;
+}
+
+// Console `ota_check`: run a check now, even with ota_enabled off
+void otaPullNow()
+{
+  if (!hOtaPull)
+    return;
+  pull.forced = true;
+  xTaskNotifyGive(hOtaPull);
+}
+
+// ============================================================
+// 📊 Status
+// ============================================================
+void fillOtaPullStatus(JsonObject o)
+{
+  static const char *states[] = {"idle", "checking", "downloading", "wait_reboot", "failed"};
+
+  o[F("enabled")] = g_settings.ota_enabled;
+  o[F("url")] = g_settings.ota_url;
+  o[F("state")] = states[(uint8_t)pull.state];
+  o[F("running_version")] = buildNumber;
+  o[F("remote_version")] = pull.remoteVersion;
+  o[F("downloaded")] = pull.downloaded;
+  o[F("total")] = pull.total;
+  o[F("resumes")] = pull.resumes;
+  o[F("last_check_s")] = pull.lastCheck ? (long)((millis() - pull.lastCheck) / 1000) : -1L;
+  if (pull.error[0])
+    o[F("error")] = pull.error;
+}
+
+String otaPullReport()
+{
+  JsonDocument doc;
+  fillOtaPullStatus(doc.to<JsonObject>());
+  String out;
+  serializeJsonPretty(doc, out);
+  return out;
+}
@@ -0,0 +1,502 @@
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <Update.h>
+#include "project_config.h"
+#include "inflate_stream.h"
+#include "mbedtls/sha256.h"
+#include "esp_spi_flash.h"
+
+// ============================================================
+// 🔁 OTA upload pipeline
+// ------------------------------------------------------------
+//   TCP chunk → staging buffer (one flash sector) → Update.write
+//                     └─ streaming SHA-256 of the image
+//
+// - Flash is written in whole sectors, never in TCP-sized bits
+// - Short writes abort the update instead of being ignored
+// - An optional client digest (?sha256=<hex> or X-SHA256
+//   header) must match before the image is committed
+// - The reboot is deferred to a timer; no delay() runs inside
+//   the AsyncTCP callbacks
+// - gzip-compressed uploads (.bin.gz) are inflated on the fly;
+//   the digest always refers to the decompressed image
+// - A dry run (?dry_run=1) only inflates and hashes: the flash
+//   is never touched, so it is safe on /updatefs as well
+// - A session belongs to whoever opened it (the upload request,
+//   or the background updater): only the owner can write to it
+//   or commit it, and a client that disconnects mid-upload
+//   aborts its own session; all entry points run under one
+//   (recursive) lock, since the HTTP handlers (async_tcp) and the
+//   background updater (OtaPull) share the session
+// - Uploads are refused with 409 while the background updater
+//   is busy, and it waits while an upload runs
+// ============================================================
+
+#ifndef OTA_STAGE_SIZE
+#define OTA_STAGE_SIZE SPI_FLASH_SEC_SIZE
+#endif
+
+enum class OtaState : uint8_t
+{
+  IDLE,
+  RECEIVING,
+  SUCCESS,
+  FAILED
+};
+
+struct OtaSession
+{
+  OtaState state = OtaState::IDLE;
+  const void *owner = nullptr;   // Request (or task) that opened the session
+  int command = U_FLASH;
+  size_t staged = 0;
+  size_t received = 0;
+  size_t written = 0;
+  bool hasDigest = false;
+  bool digestOk = false;
+  bool dryRun = false;       // Inflate and hash only, no Update.* calls
+  bool compressed = false;
+  size_t wireBytes = 0;      // Bytes received over HTTP (compressed size)
+  uint32_t heapStart = 0;
+  uint32_t heapMin = 0;
+  uint8_t expected[32];
+  mbedtls_sha256_context sha;
+
+  // Per-phase timing
+  uint32_t tStart = 0;      // millis() at first chunk
+  uint32_t receiveMs = 0;   // first → last chunk (wall time)
+  uint32_t writeUs = 0;     // time spent in Update.write()
+  uint32_t hashUs = 0;      // time spent hashing
+  uint32_t verifyUs = 0;    // digest check + Update.end()
+  uint32_t inflateUs = 0;   // time spent decompressing
+
+  char error[96] = "";
+};
+
+alignas(4) static uint8_t otaStage[OTA_STAGE_SIZE];
+static OtaSession ota;
+static InflateStream otaInflate;
+static TimerHandle_t tRestart = nullptr;
+static SemaphoreHandle_t otaMutex = xSemaphoreCreateRecursiveMutex();
+
+struct OtaLock
+{
+  OtaLock() { xSemaphoreTakeRecursive(otaMutex, portMAX_DELAY); }
+  ~OtaLock() { xSemaphoreGiveRecursive(otaMutex); }
+};
+
+// ============================================================
+// ⏲️ Deferred restart
+// ============================================================
+static void restartCb(TimerHandle_t)
+{
+  ESP.restart();
+}
+
+void scheduleRestart(uint32_t delayMs)
+{
+  if (!tRestart)
+    tRestart = xTimerCreate("restart", pdMS_TO_TICKS(delayMs), pdFALSE, nullptr, restartCb);
+  if (!tRestart)
+  {
+    LOGE("[OTA] Restart timer create FAIL, restarting now");
+    ESP.restart();
+  }
+  xTimerChangePeriod(tRestart, pdMS_TO_TICKS(delayMs), 0);
+  xTimerStart(tRestart, 0);
+  LOGI("Restart scheduled in %lu ms", (unsigned long)delayMs);
+}
+
+// ============================================================
+// 🧩 Helpers
+// ============================================================
+static bool parseHexDigest(const String &hex, uint8_t out[32])
+{
+  if (hex.length() != 64)
+    return false;
+  for (int i = 0; i < 32; i++)
+  {
+    char buf[3] = {hex[2 * i], hex[2 * i + 1], 0};
+    char *end;
+    out[i] = (uint8_t)strtoul(buf, &end, 16);
+    if (*end)
+      return false;
+  }
+  return true;
+}
+
+__attribute__((format(printf, 1, 2)))
+static void otaFail(const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(ota.error, sizeof(ota.error), fmt, args);
+  va_end(args);
+
+  if (ota.state == OtaState::RECEIVING)
+  {
+    if (!ota.dryRun)
+      Update.abort();
+    mbedtls_sha256_free(&ota.sha);
+  }
+  ota.state = OtaState::FAILED;
+  LOGE("[OTA] %s", ota.error);
+}
+
+static bool flushStage()
+{
+  if (!ota.staged)
+    return true;
+  if (ota.dryRun)
+  {
+    ota.written += ota.staged;
+    ota.staged = 0;
+    return true;
+  }
+
+  uint32_t t = micros();
+  size_t w = Update.write(otaStage, ota.staged);
+  ota.writeUs += micros() - t;
+
+  if (w != ota.staged)
+  {
+    otaFail("Flash write short: %u/%u bytes (%s)", (unsigned)w, (unsigned)ota.staged, Update.errorString());
+    return false;
+  }
+  ota.written += w;
+  ota.staged = 0;
+  return true;
+}
+
+// ============================================================
+// 🔌 Pipeline API (also used by the background updater)
+// ============================================================
+bool otaBegin(const void *owner, int command, size_t size, const char *sha256Hex, bool dryRun)
+{
+  OtaLock lock;
+  if (ota.state == OtaState::RECEIVING)
+  {
+    LOGW("[OTA] Update already in progress");
+    return false;
+  }
+
+  ota = OtaSession();
+  ota.owner = owner;
+  ota.command = command;
+  ota.dryRun = dryRun;
+  ota.tStart = millis();
+
+  ota.hasDigest = sha256Hex && *sha256Hex;
+  if (ota.hasDigest && !parseHexDigest(sha256Hex, ota.expected))
+  {
+    otaFail("Invalid SHA-256 digest (expected 64 hex chars)");
+    return false;
+  }
+
+  if (!dryRun && !Update.begin(size ? size : UPDATE_SIZE_UNKNOWN, command))
+  {
+    snprintf(ota.error, sizeof(ota.error), "Update.begin failed: %s", Update.errorString());
+    ota.state = OtaState::FAILED;
+    LOGE("[OTA] %s", ota.error);
+    return false;
+  }
+
+  mbedtls_sha256_init(&ota.sha);
+  mbedtls_sha256_starts(&ota.sha, 0);
+  ota.state = OtaState::RECEIVING;
+  LOGI("[OTA] Begin %s %s (%u bytes, digest %s)",
+       command == U_FLASH ? "firmware" : "LittleFS", dryRun ? "dry run" : "update",
+       (unsigned)size, ota.hasDigest ? "given" : "none");
+  return true;
+}
+
+bool otaWrite(const void *owner, const uint8_t *data, size_t len)
+{
+  OtaLock lock;
+  if (ota.state != OtaState::RECEIVING || ota.owner != owner)
+    return false;
+
+  uint32_t t = micros();
+  mbedtls_sha256_update(&ota.sha, data, len);
+  ota.hashUs += micros() - t;
+  ota.received += len;
+
+  while (len)
+  {
+    size_t n = min(len, sizeof(otaStage) - ota.staged);
+    memcpy(otaStage + ota.staged, data, n);
+    ota.staged += n;
+    data += n;
+    len -= n;
+
+    if (ota.staged == sizeof(otaStage) && !flushStage())
+      return false;
+  }
+  return true;
+}
+
+bool otaEnd(const void *owner)
+{
+  OtaLock lock;
+  if (ota.state != OtaState::RECEIVING || ota.owner != owner)
+    return false;
+
+  ota.receiveMs = millis() - ota.tStart;
+  if (!flushStage())
+    return false;
+
+  uint32_t t = micros();
+  uint8_t digest[32];
+  mbedtls_sha256_finish(&ota.sha, digest);
+  mbedtls_sha256_free(&ota.sha);
+
+  if (ota.hasDigest)
+  {
+    ota.digestOk = memcmp(digest, ota.expected, sizeof(digest)) == 0;
+    if (!ota.digestOk)
+    {
+      ota.verifyUs = micros() - t;
+      if (!ota.dryRun)
+        Update.abort();
+      ota.state = OtaState::FAILED;
+      snprintf(ota.error, sizeof(ota.error), "SHA-256 mismatch, image discarded");
+      LOGE("[OTA] %s", ota.error);
+      return false;
+    }
+  }
+
+  if (ota.dryRun)
+  {
+    ota.verifyUs = micros() - t;
+    ota.state = OtaState::SUCCESS;
+    LOGI("[OTA] Dry run: %u bytes hashed in %lu ms, nothing written",
+         (unsigned)ota.written, (unsigned long)ota.receiveMs);
+    return true;
+  }
+
+  if (!Update.end(true))
+  {
+    ota.verifyUs = micros() - t;
+    ota.state = OtaState::FAILED;
+    snprintf(ota.error, sizeof(ota.error), "Update.end failed: %s", Update.errorString());
+    LOGE("[OTA] %s", ota.error);
+    return false;
+  }
+  ota.verifyUs = micros() - t;
+  ota.state = OtaState::SUCCESS;
+
+  uint32_t ms = max<uint32_t>(ota.receiveMs, 1);
+  LOGI("[OTA] Done: %u bytes in %lu ms (%.1f KB/s) | write %lu ms, hash %lu ms, verify %lu ms",
+       (unsigned)ota.written, (unsigned long)ms, ota.written / 1.024f / ms,
+       (unsigned long)(ota.writeUs / 1000), (unsigned long)(ota.hashUs / 1000),
+       (unsigned long)(ota.verifyUs / 1000));
+  return true;
+}
+
+// Fails `owner`'s update. A check that fails before otaBegin
+// (e.g. a delta patch for another firmware) is reported the same
+// way, unless someone else's update is running.
+void otaAbort(const void *owner, const char *reason)
+{
+  OtaLock lock;
+  if (ota.owner != owner)
+  {
+    if (ota.state == OtaState::RECEIVING)
+      return;
+    ota = OtaSession();
+    ota.owner = owner;
+  }
+  if (ota.state != OtaState::FAILED)
+    otaFail("%s", reason);
+}
+
+// The owner went away (client disconnected): drop its session
+// if it is still open and forget the owner.
+void otaRelease(const void *owner)
+{
+  OtaLock lock;
+  if (ota.owner != owner)
+    return;
+  if (ota.state == OtaState::RECEIVING)
+  {
+    otaInflate.end();
+    otaFail("Client disconnected during the upload");
+  }
+  ota.owner = nullptr;
+}
+
+bool otaOwnedBy(const void *owner)
+{
+  return owner && ota.owner == owner;
+}
+
+bool otaInProgress()
+{
+  return ota.state == OtaState::RECEIVING;
+}
+
+const char *otaError()
+{
+  return ota.error;
+}
+
+// ============================================================
+// 🌐 HTTP upload handlers
+// ============================================================
+static String requestDigest(AsyncWebServerRequest *request)
+{
+  if (request->hasParam("sha256"))
+    return request->getParam("sha256")->value();
+  if (request->hasHeader("X-SHA256"))
+    return request->header("X-SHA256");
+  return String();
+}
+
+static bool inflateSink(const uint8_t *data, size_t len, void *owner)
+{
+  return otaWrite(owner, data, len);
+}
+
+static bool isGzip(const String &filename, const uint8_t *data, size_t len)
+{
+  return (len >= 2 && data[0] == 0x1f && data[1] == 0x8b) || filename.endsWith(".gz");
+}
+
+static void handleUpload(int command, size_t &progress, size_t &total,
+                         AsyncWebServerRequest *request, const String &filename,
+                         size_t index, uint8_t *data, size_t len, bool final)
+{
+  OtaLock lock;
+  if (!index)
+  {
+    uint32_t heap = ESP.getFreeHeap();
+    bool dryRun = request->hasParam("dry_run") && request->getParam("dry_run")->value() != "0";
+    if (otaPullBusy())
+      LOGW("[OTA] Upload refused, background update busy");
+    else if (otaBegin(request, command, 0, requestDigest(request).c_str(), dryRun))
+    {
+      progress = 0;
+      total = request->contentLength();
+      ota.heapStart = ota.heapMin = heap;
+      ota.compressed = isGzip(filename, data, len);
+      if (ota.compressed && !otaInflate.begin(InflateStream::GZIP))
+        otaFail("Not enough memory to decompress (%u bytes needed)", (unsigned)InflateStream::memoryUse());
+    }
+    if (ota.owner == request)
+      routeStatsOnDisconnect(request, [request]() { otaRelease(request); });
+  }
+
+  // Chunks of an upload that did not get the pipeline are dropped;
+  // otaUploadDone answers it with 409
+  if (ota.owner != request)
+    return;
+
+  progress = index + len;
+  ota.wireBytes += len;
+
+  if (len && ota.compressed && ota.state == OtaState::RECEIVING)
+  {
+    uint32_t t = micros();
+    uint32_t sinkUs = ota.writeUs + ota.hashUs;
+    bool ok = otaInflate.feed(data, len, inflateSink, request);
+    ota.inflateUs += (micros() - t) - (ota.writeUs + ota.hashUs - sinkUs);
+    if (!ok)
+    {
+      if (ota.state == OtaState::RECEIVING)
+        otaFail("Corrupt compressed image");
+      otaInflate.end();
+    }
+  }
+  else if (len && !ota.compressed)
+  {
+    otaWrite(request, data, len);
+  }
+  ota.heapMin = min(ota.heapMin, ESP.getFreeHeap());
+
+  if (!final)
+    return;
+
+  if (ota.compressed)
+  {
+    bool complete = otaInflate.done();
+    otaInflate.end();
+    if (!complete && ota.state == OtaState::RECEIVING)
+    {
+      otaFail("Compressed image ended early");
+      return;
+    }
+  }
+  otaEnd(request);
+}
+
+void handleUpdateFirmware(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+{
+  handleUpload(U_FLASH, currentOTAProgress, totalOTABytes, request, filename, index, data, len, final);
+}
+
+void handleUpdateLittleFS(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
+{
+  handleUpload(U_SPIFFS, currentFSProgress, totalFSBytes, request, filename, index, data, len, final);
+}
+
+// Completion handler for /firmware_update and /updatefs: reports the
+// outcome once the whole body has been processed.
+void otaUploadDone(AsyncWebServerRequest *request)
+{
+  OtaLock lock;
+  if (!otaOwnedBy(request))
+  {
+    request->send(409, "text/plain", F("❌ Another update is in progress"));
+    return;
+  }
+  if (ota.state == OtaState::SUCCESS && ota.dryRun)
+  {
+    request->send(200, "text/plain", F("✅ Dry run OK, image verified, nothing written"));
+  }
+  else if (ota.state == OtaState::SUCCESS)
+  {
+    request->send(200, "text/plain", F("✅ Update successful! Restarting in 2 seconds..."));
+    scheduleRestart(2000);
+  }
+  else
+  {
+    if (ota.state == OtaState::RECEIVING)
+      otaFail("Upload ended before the final chunk");
+    request->send(500, "text/plain", String(F("❌ Update failed: ")) + ota.error);
+  }
+}
+
+// ============================================================
+// 📊 Status (/ota_status)
+// ============================================================
+void fillOtaStatus(JsonDocument &doc)
+{
+  static const char *states[] = {"idle", "receiving", "success", "failed"};
+
+  float progress = 0;
+  if (totalOTABytes > 0)
+    progress = (float)currentOTAProgress / totalOTABytes * 100.0;
+
+  doc[F("progress")] = progress;
+  doc[F("received")] = currentOTAProgress;
+  doc[F("total")] = totalOTABytes;
+  doc[F("state")] = states[(uint8_t)ota.state];
+  doc[F("written")] = ota.written;
+  doc[F("digest_checked")] = ota.hasDigest;
+  doc[F("digest_ok")] = ota.digestOk;
+  doc[F("dry_run")] = ota.dryRun;
+  doc[F("compressed")] = ota.compressed;
+  doc[F("wire_bytes")] = ota.wireBytes;
+  doc[F("heap_peak")] = ota.heapStart - min(ota.heapStart, ota.heapMin);
+  if (ota.error[0])
+    doc[F("error")] = ota.error;
+
+  JsonObject t = doc[F("timing")].to<JsonObject>();
+  t[F("receive_ms")] = ota.state == OtaState::RECEIVING ? millis() - ota.tStart : ota.receiveMs;
+  t[F("write_ms")] = ota.writeUs / 1000;
+  t[F("hash_ms")] = ota.hashUs / 1000;
+  t[F("verify_ms")] = ota.verifyUs / 1000;
+  t[F("inflate_ms")] = ota.inflateUs / 1000;
+
+  fillOtaPullStatus(doc[F("pull")].to<JsonObject>());
+}
@@ -0,0 +1,155 @@
+#include <Arduino.h>
+#include "project_config.h"
+
+// ==========================================================
+// ⏱️ Profile registry
+// ----------------------------------------------------------
+// ProfilePoints push themselves onto a lock-free list the
+// first time their scope runs. Readers walk the list and sum
+// the per-core rows; a reading taken while a scope is being
+// recorded may be off by one sample, which is fine here.
+// ==========================================================
+#if PROFILE_ENABLED
+
+static ProfilePoint *profileHead = nullptr;
+
+ProfilePoint::ProfilePoint(const char *n) : name(n), next(nullptr)
+{
+  memset(cores, 0, sizeof(cores));
+  ProfilePoint *head = __atomic_load_n(&profileHead, __ATOMIC_RELAXED);
+  do
+    next = head;
+  while (!__atomic_compare_exchange_n(&profileHead, &head, this, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+struct ProfileSummary
+{
+  uint32_t count;
+  uint32_t maxCycles;
+  uint64_t sumCycles;
+  uint32_t buckets[PROFILE_BUCKETS];
+};
+
+static void summarize(const ProfilePoint::Core &c, ProfileSummary &s)
+{
+  s.count += __atomic_load_n(&c.count, __ATOMIC_RELAXED);
+  s.sumCycles += c.sumCycles;
+  s.maxCycles = max(s.maxCycles, __atomic_load_n(&c.maxCycles, __ATOMIC_RELAXED));
+  for (int b = 0; b < PROFILE_BUCKETS; b++)
+    s.buckets[b] += __atomic_load_n(&c.buckets[b], __ATOMIC_RELAXED);
+}
+
+// Cycles at quantile q, linear inside the log2 bucket
+static float quantileCycles(const ProfileSummary &s, float q)
+{
+  uint32_t total = 0;
+  for (int b = 0; b < PROFILE_BUCKETS; b++)
+    total += s.buckets[b];
+  if (!total)
+    return 0;
+
+  float rank = q * total;
+  uint32_t below = 0;
+  for (int b = 0; b < PROFILE_BUCKETS; b++)
+  {
+    if (below + s.buckets[b] >= rank && s.buckets[b])
+    {
+      float lo = b ? (float)(1ULL << (b - 1)) : 0;
+      float hi = b ? (float)(1ULL << b) : 1;
+      float hiClamped = min(hi, (float)s.maxCycles);
+      return lo + (hiClamped - lo) * ((rank - below) / s.buckets[b]);
+    }
+    below += s.buckets[b];
+  }
+  return s.maxCycles;
+}
+
+static float toUs(float cycles)
+{
+  return cycles / getCpuFrequencyMhz();
+}
+
+static void fillSummary(JsonObject o, const ProfileSummary &s)
+{
+  o[F("count")] = s.count;
+  o[F("mean_us")] = s.count ? roundf(toUs((float)s.sumCycles / s.count) * 10) / 10 : 0;
+  o[F("p50_us")] = roundf(toUs(quantileCycles(s, 0.50f)) * 10) / 10;
+  o[F("p99_us")] = roundf(toUs(quantileCycles(s, 0.99f)) * 10) / 10;
+  o[F("max_us")] = roundf(toUs(s.maxCycles) * 10) / 10;
+}
+
+// ==========================================================
+// 📤 /api/profile
+// ==========================================================
+void fillProfile(JsonDocument &doc)
+{
+  doc[F("enabled")] = true;
+  doc[F("cpu_mhz")] = getCpuFrequencyMhz();
+  JsonArray scopes = doc[F("scopes")].to<JsonArray>();
+
+  for (ProfilePoint *p = __atomic_load_n(&profileHead, __ATOMIC_ACQUIRE); p; p = p->next)
+  {
+    JsonObject o = scopes.add<JsonObject>();
+    o[F("name")] = p->name;
+
+    ProfileSummary all = {};
+    JsonArray cores = o[F("cores")].to<JsonArray>();
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+    {
+      ProfileSummary one = {};
+      summarize(p->cores[c], one);
+      summarize(p->cores[c], all);
+      fillSummary(cores.add<JsonObject>(), one);
+    }
+    fillSummary(o, all);
+
+    JsonArray hist = o[F("log2_cycles")].to<JsonArray>();
+    int last = PROFILE_BUCKETS - 1;
+    while (last > 0 && !all.buckets[last])
+      last--;
+    for (int b = 0; b <= last; b++)
+      hist.add(all.buckets[b]);
+  }
+}
+
+String profileReport()
+{
+  String out = "=== profile (" + String(getCpuFrequencyMhz()) + " MHz) ===\n";
+  char line[128];
+  snprintf(line, sizeof(line), "%-26s %8s %9s %9s %9s %9s\n", "SCOPE", "COUNT", "MEAN_us", "P50_us", "P99_us", "MAX_us");
+  out += line;
+
+  for (ProfilePoint *p = __atomic_load_n(&profileHead, __ATOMIC_ACQUIRE); p; p = p->next)
+  {
+    ProfileSummary s = {};
+    for (int c = 0; c < portNUM_PROCESSORS; c++)
+      summarize(p->cores[c], s);
+    snprintf(line, sizeof(line), "%-26s %8lu %9.1f %9.1f %9.1f %9.1f\n", p->name, (unsigned long)s.count,
+             s.count ? toUs((float)s.sumCycles / s.count) : 0.0f,
+             toUs(quantileCycles(s, 0.50f)), toUs(quantileCycles(s, 0.99f)), toUs(s.maxCycles));
+    out += line;
+  }
+  return out;
+}
+
+void profileReset()
+{
+  for (ProfilePoint *p = __atomic_load_n(&profileHead, __ATOMIC_ACQUIRE); p; p = p->next)
+    memset(p->cores, 0, sizeof(p->cores));
+}
+
+#else
+
+void fillProfile(JsonDocument &doc)
+{
+  doc[F("enabled")] = false;
+}
+
+String profileReport()
+{
+  return "Profiling disabled (PROFILE_ENABLED=0)";
+}
+
+void profileReset() {}
+
+#endif
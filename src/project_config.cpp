@@ -22,6 +22,7 @@ String logBuffer;             // Temporary log storage
 int system_temp_pin  = 6;
 int engine_temp_pin  = 7;
 int fan_control_pin  = 8;
+int fan_tach_pin     = 39;      // 4-wire fan tach (open collector, internal pull-up)
 
 // ======================================================
 // 💡 RGB LED Configuration
@@ -63,6 +64,9 @@ NTCConstants ntcConstants;          // NTC calibration constants
 TaskHandle_t hSensors  = nullptr;   // Core 0: Sensor acquisition task
 TaskHandle_t hControl  = nullptr;   // Core 1: Fan control logic task
 TaskHandle_t hCan      = nullptr;   // Core 1: CAN bus handler
+TaskHandle_t hOtaPull  = nullptr;   // Core 0: Background OTA (lowest priority)
+TaskHandle_t hTimers   = nullptr;   // Core 0: Timer service (setTimeout / setInterval)
+TaskHandle_t hMonitor  = nullptr;   // Core 0: Per-task CPU / stack sampler (low priority)
 QueueHandle_t sensorDataQueue = nullptr;  // Queue for sensor updates
 SemaphoreHandle_t mtxState     = nullptr; // Mutex for shared state protection
 EventGroupHandle_t egFlags     = nullptr; // Event flags (e.g., heartbeat)
@@ -0,0 +1,323 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "project_config.h"
+
+// ============================================================
+// 🚦 Per-route HTTP stats
+// ------------------------------------------------------------
+// Every request is seen by RouteObserver, a handler registered
+// before all others that never claims a request: its canHandle()
+// just opens the per-request record and hooks onDisconnect().
+// At disconnect the response still exists, so the status code
+// and bytes written are read from it. The request keeps a single
+// disconnect handler: views that need their own go through
+// routeStatsOnDisconnect(), which runs the record first.
+//
+// Routes registered in initServer() get their slot up front and
+// their view is wrapped by timedView() to measure the handler
+// alone. Other URLs (files served by the "/" catch-all) get a
+// slot the first time they are requested, until the table is
+// full; the rest land in "(other)".
+//
+// All updates happen on the async_tcp task, so no locking.
+// ============================================================
+#ifndef ROUTE_STATS_MAX
+#define ROUTE_STATS_MAX 64
+#endif
+#define ROUTE_HIST_BUCKETS 16   // log2: handler in µs, total in ms
+
+struct RouteStat
+{
+  char path[32];
+  WebRequestMethod method;
+  uint32_t count;
+  uint32_t status[5];           // 1xx..5xx (index = code / 100 - 1)
+  uint64_t bytes;
+  int32_t heapLast;             // Free-heap change over the last request
+  int32_t heapWorst;            // Largest drop seen
+  uint32_t handlerMaxUs;
+  uint32_t totalMaxMs;
+  uint32_t handlerHist[ROUTE_HIST_BUCKETS];
+  uint32_t totalHist[ROUTE_HIST_BUCKETS];
+};
+
+static RouteStat routes[ROUTE_STATS_MAX];   // [0] = "(other)"
+static int routeCount = 1;
+static uint16_t inFlight = 0;
+static uint16_t inFlightPeak = 0;
+static uint32_t requestsTotal = 0;
+
+static const float DURATION_BOUNDS[] = {0.005f, 0.01f, 0.025f, 0.05f, 0.1f, 0.25f, 0.5f, 1.0f, 2.5f, 5.0f};
+static MetricHistogram mRequestSeconds("http_request_duration_seconds", "Request to disconnect, all routes",
+                                       DURATION_BOUNDS, sizeof(DURATION_BOUNDS) / sizeof(DURATION_BOUNDS[0]));
+static MetricGauge mInFlight("http_requests_in_flight", "Requests not yet disconnected",
+                             []() -> float { return inFlight; });
+
+// ============================================================
+// 🔓 Response internals
+// ------------------------------------------------------------
+// ESPAsyncWebServer 1.2.3 keeps the response and the disconnect
+// handler private to the request and the response's code / byte
+// counters protected. The request
+// member is reached with the explicit-instantiation accessor
+// idiom, the protected fields through a derived-class member
+// pointer. Both fail to compile if the library renames them.
+// ============================================================
+template <typename Tag, typename Tag::type Member>
+struct PrivateMember
+{
+  friend typename Tag::type get(Tag) { return Member; }
+};
+
+struct RequestResponseTag
+{
+  typedef AsyncWebServerResponse *AsyncWebServerRequest::*type;
+  friend type get(RequestResponseTag);
+};
+template struct PrivateMember<RequestResponseTag, &AsyncWebServerRequest::_response>;
+
+struct RequestDisconnectTag
+{
+  typedef ArDisconnectHandler AsyncWebServerRequest::*type;
+  friend type get(RequestDisconnectTag);
+};
+template struct PrivateMember<RequestDisconnectTag, &AsyncWebServerRequest::_onDisconnectfn>;
+
+struct ResponsePeek : AsyncWebServerResponse
+{
+  static int code(const AsyncWebServerResponse *r) { return r->*(&ResponsePeek::_code); }
+  static size_t written(const AsyncWebServerResponse *r) { return r->*(&ResponsePeek::_writtenLength); }
+};
+
+// ============================================================
+// 🧩 Slots
+// ============================================================
+static int findRoute(const char *path, WebRequestMethod method)
+{
+  for (int i = 1; i < routeCount; i++)
+    if (routes[i].method == method && !strcmp(routes[i].path, path))
+      return i;
+  return -1;
+}
+
+int routeStatsSlot(const char *path, WebRequestMethod method)
+{
+  int i = findRoute(path, method);
+  if (i >= 0)
+    return i;
+  if (routeCount >= ROUTE_STATS_MAX || strlen(path) >= sizeof(routes[0].path))
+    return 0;
+
+  i = routeCount++;
+  strlcpy(routes[i].path, path, sizeof(routes[i].path));
+  routes[i].method = method;
+  return i;
+}
+
+static uint8_t log2Bucket(uint32_t v)
+{
+  uint8_t b = v ? 31 - __builtin_clz(v) : 0;
+  return min<uint8_t>(b, ROUTE_HIST_BUCKETS - 1);
+}
+
+void routeStatsHandler(int slot, uint32_t us)
+{
+  RouteStat &r = routes[slot];
+  r.handlerHist[log2Bucket(us)]++;
+  r.handlerMaxUs = max(r.handlerMaxUs, us);
+}
+
+// ============================================================
+// 👀 Observer
+// ============================================================
+static void requestBegin(AsyncWebServerRequest *req)
+{
+  int slot = routeStatsSlot(req->url().c_str(), (WebRequestMethod)req->method());
+  uint32_t t0 = millis();
+  uint32_t heap0 = ESP.getFreeHeap();
+
+  requestsTotal++;
+  if (++inFlight > inFlightPeak)
+    inFlightPeak = inFlight;
+
+  req->onDisconnect([req, slot, t0, heap0]()
+                    {
+    RouteStat &r = routes[slot];
+    uint32_t ms = millis() - t0;
+    int32_t heapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heap0;
+
+    r.count++;
+    r.totalHist[log2Bucket(ms)]++;
+    r.totalMaxMs = max(r.totalMaxMs, ms);
+    mRequestSeconds.observe(ms / 1000.0f);
+    r.heapLast = heapDelta;
+    r.heapWorst = min(r.heapWorst, heapDelta);
+
+    AsyncWebServerResponse *res = req->*get(RequestResponseTag());
+    if (res)
+    {
+      int code = ResponsePeek::code(res);
+      if (code >= 100 && code < 600)
+        r.status[code / 100 - 1]++;
+      r.bytes += ResponsePeek::written(res);
+    }
+    if (inFlight)
+      inFlight--; });
+}
+
+class RouteObserver : public AsyncWebHandler
+{
+public:
+  bool canHandle(AsyncWebServerRequest *req) override
+  {
+    requestBegin(req);
+    return false;   // Never handles: the real handler runs next
+  }
+};
+
+// Adds fn after the handler already set (the stats record), so a
+// view's cleanup does not replace it
+void routeStatsOnDisconnect(AsyncWebServerRequest *req, ArDisconnectHandler fn)
+{
+  ArDisconnectHandler prev = req->*get(RequestDisconnectTag());
+  req->onDisconnect([prev, fn]()
+                    {
+    if (prev)
+      prev();
+    fn(); });
+}
+
+void routeStatsInit(AsyncWebServer &srv)
+{
+  strlcpy(routes[0].path, "(other)", sizeof(routes[0].path));
+  routes[0].method = HTTP_ANY;
+  srv.addHandler(new RouteObserver());
+}
+
+// ============================================================
+// 📤 /api/route_stats
+// ============================================================
+static const char *methodName(WebRequestMethod m)
+{
+  switch (m)
+  {
+  case HTTP_GET: return "GET";
+  case HTTP_POST: return "POST";
+  case HTTP_DELETE: return "DELETE";
+  case HTTP_PUT: return "PUT";
+  case HTTP_PATCH: return "PATCH";
+  case HTTP_HEAD: return "HEAD";
+  case HTTP_OPTIONS: return "OPTIONS";
+  default: return "ANY";
+  }
+}
+
+// Value at quantile q, linear inside the log2 bucket
+static float histQuantile(const uint32_t *hist, float q, uint32_t maxv)
+{
+  uint32_t total = 0;
+  for (int b = 0; b < ROUTE_HIST_BUCKETS; b++)
+    total += hist[b];
+  if (!total)
+    return 0;
+
+  float rank = q * total;
+  uint32_t below = 0;
+  for (int b = 0; b < ROUTE_HIST_BUCKETS; b++)
+  {
+    if (hist[b] && below + hist[b] >= rank)
+    {
+      float lo = b ? (float)(1UL << b) : 0;
+      float hi = min((float)(1UL << (b + 1)), (float)maxv);
+      return lo + (max(hi, lo) - lo) * ((rank - below) / hist[b]);
+    }
+    below += hist[b];
+  }
+  return maxv;
+}
+
+static void fillLatency(JsonObject o, const uint32_t *hist, uint32_t maxv)
+{
+  o[F("p50")] = lroundf(histQuantile(hist, 0.50f, maxv));
+  o[F("p99")] = lroundf(histQuantile(hist, 0.99f, maxv));
+  o[F("max")] = maxv;
+}
+
+void fillRouteStats(JsonDocument &doc)
+{
+  doc[F("requests")] = requestsTotal;
+  doc[F("in_flight")] = inFlight;
+  doc[F("in_flight_peak")] = inFlightPeak;
+
+  JsonArray arr = doc[F("routes")].to<JsonArray>();
+  for (int i = 0; i < routeCount; i++)
+  {
+    const RouteStat &r = routes[i];
+    if (!r.count)
+      continue;
+    JsonObject o = arr.add<JsonObject>();
+    o[F("path")] = r.path;
+    o[F("method")] = methodName(r.method);
+    o[F("count")] = r.count;
+
+    JsonObject st = o[F("status")].to<JsonObject>();
+    static const char *classes[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+    for (int c = 0; c < 5; c++)
+      if (r.status[c])
+        st[classes[c]] = r.status[c];
+
+    o[F("bytes")] = r.bytes;
+    fillLatency(o[F("handler_us")].to<JsonObject>(), r.handlerHist, r.handlerMaxUs);
+    fillLatency(o[F("total_ms")].to<JsonObject>(), r.totalHist, r.totalMaxMs);
+    o[F("heap_last")] = r.heapLast;
+    o[F("heap_worst")] = r.heapWorst;
+  }
+}
+
+void routeStatsReset()
+{
+  for (int i = 0; i < routeCount; i++)
+  {
+    RouteStat &r = routes[i];
+    char path[sizeof(r.path)];
+    WebRequestMethod method = r.method;
+    strlcpy(path, r.path, sizeof(path));
+    memset(&r, 0, sizeof(r));
+    strlcpy(r.path, path, sizeof(r.path));
+    r.method = method;
+  }
+  requestsTotal = 0;
+  inFlightPeak = inFlight;
+}
+
+// ============================================================
+// 🖥️ Console `routes` (busiest first)
+// ============================================================
+String routeStatsReport()
+{
+  int order[ROUTE_STATS_MAX];
+  int n = 0;
+  for (int i = 0; i < routeCount; i++)
+    if (routes[i].count)
+      order[n++] = i;
+  std::sort(order, order + n, [](int a, int b)
+            { return routes[a].count > routes[b].count; });
+
+  String out = "=== routes (" + String(requestsTotal) + " requests, in flight " + String(inFlight) +
+               ", peak " + String(inFlightPeak) + ") ===\n";
+  char line[144];
+  snprintf(line, sizeof(line), "%-7s %-26s %6s %5s %5s %9s %8s %8s %7s\n",
+           "METHOD", "PATH", "COUNT", "4xx", "5xx", "BYTES", "H_P99us", "T_P99ms", "HEAP");
+  out += line;
+  for (int k = 0; k < n; k++)
+  {
+    const RouteStat &r = routes[order[k]];
+    snprintf(line, sizeof(line), "%-7s %-26s %6lu %5lu %5lu %9llu %8ld %8ld %7ld\n",
+             methodName(r.method), r.path, (unsigned long)r.count,
+             (unsigned long)r.status[3], (unsigned long)r.status[4], (unsigned long long)r.bytes,
+             lroundf(histQuantile(r.handlerHist, 0.99f, r.handlerMaxUs)),
+             lroundf(histQuantile(r.totalHist, 0.99f, r.totalMaxMs)), (long)r.heapWorst);
+    out += line;
+  }
+  return out;
+}
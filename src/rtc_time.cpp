@@ -3,53 +3,61 @@
 #include <WiFi.h>
 #include <Preferences.h>
 #include "time.h"
+#include "esp_sntp.h"
+#include <sys/time.h>
 
 // NTP configuration
 const char *ntpServer = "pool.ntp.org";
-const char *TZ_IRELAND = "GMT0BST,M3.5.0/1,M10.5.0/2";  // Ireland timezone
-
-// ---------------------------------------------------------
-// 🕓 Detect if Daylight Saving Time (DST) is active
-// ---------------------------------------------------------
-bool isDST(struct tm *timeinfo)
+const char *TZ_IRELAND = "GMT0BST,M3.5.0/1,M10.5.0/2";  // Ireland timezone (DST rules included)
+
+// ============================================================
+// 🕒 Wall clock bring-up
+// ------------------------------------------------------------
+// setupTime() never waits on the network:
+//   1. the last time saved in NVS (+ uptime) is restored, so
+//      timestamps are roughly right from the first second
+//   2. SNTP starts in the background (router, then the pool)
+//   3. the sync callback marks the clock as valid
+// timeService() (from loop) writes the clock to NVS right after
+// a sync and then every TIME_SAVE_INTERVAL_MS.
+// ============================================================
+#ifndef TIME_SAVE_INTERVAL_MS
+#define TIME_SAVE_INTERVAL_MS (15UL * 60 * 1000)
+#endif
+
+enum class TimeSource : uint8_t
 {
-    int year = timeinfo->tm_year + 1900;
-    int month = timeinfo->tm_mon + 1;
-    int day = timeinfo->tm_mday;
-
-    // Before March or after October → no DST
-    if (month < 3 || month > 10)
-        return false;
-
-    // Between April and September → always DST
-    if (month > 3 && month < 10)
-        return true;
+    NONE,
+    NVS,    // Restored from the last save, not verified
+    SNTP
+};
 
-    // Compute last Sunday of March and October
-    int lastSundayMarch = 31 - ((5 * year / 4 + 4) % 7);
-    int lastSundayOctober = 31 - ((5 * year / 4 + 1) % 7);
-
-    if (month == 3)
-        return (day >= lastSundayMarch);
-    if (month == 10)
-        return (day < lastSundayOctober);
-
-    return false;
-}
+static volatile TimeSource timeSource = TimeSource::NONE;
+static volatile bool syncPending = false;    // Set by the SNTP callback
+static uint32_t lastSaveMs = 0;
+static uint32_t lastSyncMs = 0;
+static uint32_t syncCount = 0;
 
 // ---------------------------------------------------------
-// 🌐 Try to get time from a given NTP server
+// 🔔 SNTP sync notification (runs in the lwIP thread)
 // ---------------------------------------------------------
-bool tryGetTime(const char *serverName, long gmtOffset, int dstOffset)
+static void onTimeSync(struct timeval *tv)
 {
-    configTzTime(TZ_IRELAND, serverName);
-    delay(2000);
+    timeSource = TimeSource::SNTP;
+    lastSyncMs = millis();
+    syncCount++;
+    syncPending = true;   // Logged and saved from timeService()
+}
 
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
-        return false;
+bool timeIsValid()
+{
+    return timeSource == TimeSource::SNTP;
+}
 
-    return true;
+const char *timeSourceName()
+{
+    static const char *names[] = {"none", "nvs", "sntp"};
+    return names[(uint8_t)timeSource];
 }
 
 // ---------------------------------------------------------
@@ -57,20 +65,37 @@ bool tryGetTime(const char *serverName, long gmtOffset, int dstOffset)
 // ---------------------------------------------------------
 void saveTimeToNVS()
 {
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
+    if (timeSource == TimeSource::NONE)
         return;
 
-    prefs.begin("time", false);
-    prefs.putInt("year", timeinfo.tm_year + 1900);
-    prefs.putInt("month", timeinfo.tm_mon + 1);
-    prefs.putInt("day", timeinfo.tm_mday);
-    prefs.putInt("hour", timeinfo.tm_hour);
-    prefs.putInt("minute", timeinfo.tm_min);
-    prefs.putInt("second", timeinfo.tm_sec);
-    prefs.end();
+    Preferences nvs;   // Own handle; `prefs` is shared with other tasks
+    nvs.begin("time", false);
+    nvs.putULong64("epoch", (uint64_t)time(nullptr));
+    nvs.end();
+    lastSaveMs = millis();
+    LOGD("💾 Time saved to NVS.");
+}
 
-    Serial.println("💾 Time saved to NVS.");
+// Saved epoch, or 0. Older firmware stored broken-down local time.
+static time_t loadEpochFromNVS()
+{
+    Preferences nvs;
+    nvs.begin("time", true);
+    time_t epoch = (time_t)nvs.getULong64("epoch", 0);
+    if (!epoch && nvs.getInt("year", 0))
+    {
+        struct tm t = {};
+        t.tm_year = nvs.getInt("year", 0) - 1900;
+        t.tm_mon = nvs.getInt("month", 1) - 1;
+        t.tm_mday = nvs.getInt("day", 1);
+        t.tm_hour = nvs.getInt("hour", 0);
+        t.tm_min = nvs.getInt("minute", 0);
+        t.tm_sec = nvs.getInt("second", 0);
+        t.tm_isdst = -1;
+        epoch = mktime(&t);
+    }
+    nvs.end();
+    return epoch;
 }
 
 // ---------------------------------------------------------
@@ -78,24 +103,10 @@ void saveTimeToNVS()
 // ---------------------------------------------------------
 bool loadTimeFromNVS(struct tm &timeinfo)
 {
-    prefs.begin("time", true);
-    int year = prefs.getInt("year", 0);
-    int month = prefs.getInt("month", 0);
-    int day = prefs.getInt("day", 0);
-    int hour = prefs.getInt("hour", 0);
-    int minute = prefs.getInt("minute", 0);
-    int second = prefs.getInt("second", 0);
-    prefs.end();
-
-    if (year == 0)
+    time_t epoch = loadEpochFromNVS();
+    if (!epoch)
         return false;
-
-    timeinfo.tm_year = year - 1900;
-    timeinfo.tm_mon = month - 1;
-    timeinfo.tm_mday = day;
-    timeinfo.tm_hour = hour;
-    timeinfo.tm_min = minute;
-    timeinfo.tm_sec = second;
+    localtime_r(&epoch, &timeinfo);
     return true;
 }
 
@@ -105,66 +116,77 @@ bool loadTimeFromNVS(struct tm &timeinfo)
 void printLocalTime()
 {
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
+    if (!getLocalTime(&timeinfo, 0))
     {
-        Serial.println("❌ Failed to obtain time");
+        LOGW("❌ Failed to obtain time");
         return;
     }
 
-    Serial.printf("🕒 Current time: %02d:%02d:%02d  %02d/%02d/%04d\n",
-                  timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
-                  timeinfo.tm_mday, timeinfo.tm_mon + 1, timeinfo.tm_year + 1900);
+    LOGI("🕒 Current time: %02d:%02d:%02d  %02d/%02d/%04d (%s)",
+         timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
+         timeinfo.tm_mday, timeinfo.tm_mon + 1, timeinfo.tm_year + 1900, timeSourceName());
 }
 
 // ---------------------------------------------------------
-// ⏳ Main time initialization sequence
+// ⏳ Main time initialization sequence (non-blocking)
 // ---------------------------------------------------------
 void setupTime()
 {
-    struct tm timeinfo;
+    setenv("TZ", TZ_IRELAND, 1);
+    tzset();
 
-    Serial.println("⏳ Attempting full time sync...");
-
-    // 1️⃣ Try local router as NTP server
-    IPAddress routerIP = WiFi.gatewayIP();
-    String routerStr = routerIP.toString();
-    Serial.printf("🌐 Trying router NTP at %s\n", routerStr.c_str());
-    if (tryGetTime(routerStr.c_str(), 0, 0))
+    // 1️⃣ Last known time + uptime, until SNTP answers
+    if (time(nullptr) < 1577836800)   // Before 2020: clock not set
     {
-        Serial.println("✅ Time synchronized from router");
-        saveTimeToNVS();
-        printLocalTime();
-        return;
+        time_t saved = loadEpochFromNVS();
+        if (saved)
+        {
+            struct timeval tv = {saved + (time_t)(millis() / 1000), 0};
+            settimeofday(&tv, nullptr);
+            timeSource = TimeSource::NVS;
+            LOGI("🕒 Clock restored from NVS: %s", getDateTime().c_str());
+        }
+        else
+        {
+            LOGW("❌ No saved time in NVS, clock starts at 1970 until SNTP sync");
+        }
     }
 
-    // 2️⃣ Try public NTP pool
-    Serial.println("🌍 Trying public NTP pool...");
-    if (tryGetTime(ntpServer, 0, 0))
-    {
-        Serial.println("✅ Time synchronized from internet");
-        saveTimeToNVS();
-
-        getLocalTime(&timeinfo);
-        bool dst = isDST(&timeinfo);
+    // 2️⃣ SNTP in the background: router first, then the public pool
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    IPAddress router = WiFi.gatewayIP();
+    static String routerStr;   // configTzTime keeps the pointer
+    routerStr = router.toString();
+    if (router != IPAddress((uint32_t)0))
+        configTzTime(TZ_IRELAND, routerStr.c_str(), ntpServer);
+    else
+        configTzTime(TZ_IRELAND, ntpServer);
 
-        Serial.printf("🇮🇪 DST active: %s\n", dst ? "Yes (+1h)" : "No");
-        configTime(0, dst ? 3600 : 0, ntpServer);
+    LOGI("⏳ SNTP started (%s%s), not waiting for it", router != IPAddress((uint32_t)0) ? "router, " : "", ntpServer);
+}
 
-        delay(1000);
-        printLocalTime();
+// ---------------------------------------------------------
+// 🔁 Periodic work (called from loop)
+// ---------------------------------------------------------
+void timeService()
+{
+    if (syncPending)
+    {
+        syncPending = false;
+        LOGI("✅ Time synchronized (sync #%lu): %s", (unsigned long)syncCount, getDateTime().c_str());
+        saveTimeToNVS();
         return;
     }
 
-    // 3️⃣ Fallback to last saved time from NVS
-    Serial.println("⚠️ Using last saved time from NVS (if available)...");
-    if (loadTimeFromNVS(timeinfo))
-    {
-        Serial.printf("🕒 Recovered saved time: %02d:%02d:%02d  %02d/%02d/%04d\n",
-                      timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
-                      timeinfo.tm_mday, timeinfo.tm_mon + 1, timeinfo.tm_year + 1900);
-    }
-    else
-    {
-        Serial.println("❌ No valid time available in NVS.");
-    }
+    if (timeSource != TimeSource::NONE && millis() - lastSaveMs >= TIME_SAVE_INTERVAL_MS)
+        saveTimeToNVS();
+}
+
+String timeReport()
+{
+    String out = "Current time=" + getDateTime() + " source=" + timeSourceName();
+    out += " syncs=" + String(syncCount);
+    if (lastSyncMs)
+        out += " last_sync=" + String((millis() - lastSyncMs) / 1000) + "s ago";
+    return out;
 }
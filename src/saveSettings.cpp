@@ -6,10 +6,24 @@
 // Global system settings structure
 SystemSettings g_settings;
 
+// Bumped whenever g_settings may have changed (apply, save,
+// console edits); /api/status uses it instead of hashing fields
+static uint32_t settingsRev = 1;
+
+void settingsTouch()
+{
+    __atomic_fetch_add(&settingsRev, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t settingsRevision()
+{
+    return __atomic_load_n(&settingsRev, __ATOMIC_RELAXED);
+}
+
 // =======================================================
 // 🧩 Fill JSON Document from SystemSettings structure
 // =======================================================
-void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
+void fillJsonFrom(const SystemSettings &s, JsonObject doc)
 {
     // --- General ---
     doc["hostname"] = s.hostname;
@@ -30,6 +44,10 @@ void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
     doc["temp_sample_interval_ms"] = s.temp_sample_interval_ms;
     doc["adc_samples"] = s.adc_samples;
     doc["temp_sensor_type"] = s.temp_sensor_type;
+    doc["temp_filter_enabled"] = s.temp_filter_enabled;
+    doc["temp_predict_s"] = s.temp_predict_s;
+    doc["temp_fuse_ntc"] = s.temp_fuse_ntc;
+    doc["temp_stale_ms"] = s.temp_stale_ms;
     doc["alarmTriggered"] = s.alarmTriggered;
     doc["reactivateAlarmCounter"] = s.reactivateAlarmCounter;
 
@@ -50,6 +68,15 @@ void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
 
     doc["fan_control_interval"] = s.fan_control_interval;
     doc["fan_start_boost_ms"] = s.fan_start_boost_ms;
+    doc["fan_start_boost_pct"] = s.fan_start_boost_pct;
+    doc["fan_slew_pct_per_s"] = s.fan_slew_pct_per_s;
+    doc["fan_tach_enabled"] = s.fan_tach_enabled;
+    doc["fan_tach_ppr"] = s.fan_tach_ppr;
+    doc["fan_rpm_window_ms"] = s.fan_rpm_window_ms;
+    doc["fan_stall_ms"] = s.fan_stall_ms;
+    doc["fan_max_rpm"] = s.fan_max_rpm;
+    doc["fan_closed_loop"] = s.fan_closed_loop;
+    doc["fan_failsafe_pct"] = s.fan_failsafe_pct;
     doc["pwm_freq_hz"] = s.pwm_freq_hz;
     doc["pwm_channel"] = s.pwm_channel;
     doc["pwm_resolution_bits"] = s.pwm_resolution_bits;
@@ -57,6 +84,9 @@ void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
     doc["manual_percent"] = s.manual_percent;
     doc["manual_on"] = s.manual_on;
 
+    // --- Fan Zones ---
+    fillZoneSettings(s, doc["zones"].to<JsonArray>());
+
     // --- UI Mapping ---
     doc["ui_system_min"] = s.ui_system_min;
     doc["ui_system_max"] = s.ui_system_max;
@@ -65,12 +95,20 @@ void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
     doc["deactivateAlarmTime"] = s.deactivateAlarmTime;
 }
 
+void fillJsonFrom(const SystemSettings &s, JsonDocument &doc)
+{
+    fillJsonFrom(s, doc.to<JsonObject>());
+}
+
 // =======================================================
 // 💾 Save current settings to LittleFS
 // =======================================================
 bool settingsSaveToFS()
 {
-    JsonDocument newDoc;
+    PROFILE_SCOPE("settingsSaveToFS");
+    settingsTouch();
+    JsonArenaScope arena;
+    JsonDocument newDoc(arena.allocator());
     fillJsonFrom(g_settings, newDoc);
 
     // --- Check if an existing settings file already exists ---
@@ -79,7 +117,7 @@ bool settingsSaveToFS()
         File fOld = LittleFS.open(fileSettingsPath, "r");
         if (fOld)
         {
-            JsonDocument oldDoc;
+            JsonDocument oldDoc(arena.allocator());
             DeserializationError err = deserializeJson(oldDoc, fOld);
             if (!err)
             {
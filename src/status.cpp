@@ -0,0 +1,289 @@
+#include <Arduino.h>
+#include "project_config.h"
+#include <WiFi.h>
+#include <ArduinoJson.h>
+
+// ============================================================
+// 📸 Aggregated status snapshot (/api/status)
+// ------------------------------------------------------------
+// One request returns everything the UI pages used to poll
+// separately (/api/sensors, /api/settings, /alarma, /meminfo),
+// built from cached state in a single pass.
+//
+//   /api/status?fields=temps,fan   → only the listed sections
+//   /api/status?since=<gen>        → 304 if nothing changed
+// ============================================================
+
+enum StatusSection : uint16_t
+{
+  SEC_TEMPS = 1 << 0,
+  SEC_FAN = 1 << 1,
+  SEC_SYS = 1 << 2,
+  SEC_HW = 1 << 3,
+  SEC_LOGIC = 1 << 4,
+  SEC_SETTINGS = 1 << 5,
+  SEC_SENSORS = 1 << 6,
+  SEC_ALARM = 1 << 7,
+  SEC_ALL = 0xFFFF
+};
+
+static const struct
+{
+  const char *name;
+  uint16_t bit;
+} sectionNames[] = {
+    {"temps", SEC_TEMPS},
+    {"fan", SEC_FAN},
+    {"sys", SEC_SYS},
+    {"hw", SEC_HW},
+    {"logic", SEC_LOGIC},
+    {"settings", SEC_SETTINGS},
+    {"sensors", SEC_SENSORS},
+    {"alarm", SEC_ALARM},
+};
+
+// Parse "temps,fan,sys.wifi" → section mask (sub-paths select their parent)
+static uint16_t parseFields(const String &fields)
+{
+  uint16_t mask = 0;
+  int start = 0;
+  while (start <= (int)fields.length())
+  {
+    int comma = fields.indexOf(',', start);
+    if (comma < 0)
+      comma = fields.length();
+    String name = fields.substring(start, comma);
+    int dot = name.indexOf('.');
+    if (dot >= 0)
+      name = name.substring(0, dot);
+    name.trim();
+
+    for (auto &s : sectionNames)
+    {
+      if (name.equalsIgnoreCase(s.name))
+        mask |= s.bit;
+    }
+    start = comma + 1;
+  }
+  return mask ? mask : (uint16_t)SEC_ALL;
+}
+
+// ============================================================
+// 🔢 Generation number
+// ------------------------------------------------------------
+// A fingerprint of what the requested sections show: live
+// readings (temps at 0.1 °C, fan output, tach, estimates,
+// heap/RSSI/uptime for sys, alarm) plus the settings revision
+// for the sections built from g_settings. It is returned as
+// `gen`; a client that sends it back as `since=` gets a 304
+// until something it asked for changes. Polling `sys` therefore
+// refreshes every second, a temps/fan-only poll does not.
+// ============================================================
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+  const uint8_t *p = (const uint8_t *)data;
+  for (size_t i = 0; i < len; i++)
+    h = (h ^ p[i]) * 16777619u;
+  return h;
+}
+
+template <typename T>
+static uint32_t mix(uint32_t h, const T &v)
+{
+  return fnv1a(h, &v, sizeof(v));
+}
+
+static int16_t deci(float c)
+{
+  return isnan(c) ? INT16_MIN : (int16_t)lroundf(c * 10.0f);
+}
+
+static int16_t centi(float v)
+{
+  return isnan(v) ? INT16_MIN : (int16_t)lroundf(v * 100.0f);
+}
+
+static bool alarmActive()
+{
+  return (millis() - g_settings.reactivateAlarmCounter) < g_settings.deactivateAlarmTime;
+}
+
+static uint32_t statusGeneration(uint16_t mask)
+{
+  const SystemSettings &s = g_settings;
+  uint32_t h = mix(2166136261u, mask);
+
+  // hw, logic and settings only show g_settings
+  if (mask & (SEC_HW | SEC_LOGIC | SEC_SETTINGS))
+    h = mix(h, settingsRevision());
+
+  if (mask & (SEC_TEMPS | SEC_SENSORS))
+  {
+    h = mix(h, deci(sensorData.systemC));
+    h = mix(h, deci(sensorData.engineC));
+    h = mix(h, deci(sensorData.engineEstC));
+    h = mix(h, centi(sensorData.engineRate));
+  }
+  if (mask & (SEC_FAN | SEC_SENSORS))
+  {
+    h = mix(h, sensorData.targetPercent);
+    h = mix(h, sensorData.target_pwm);
+    h = mix(h, (uint8_t)s.fan_mode);
+    h = mix(h, s.manual_on);
+    h = mix(h, s.manual_percent);
+  }
+  if (mask & SEC_SENSORS)
+  {
+    float rpm = fanTachRpm();
+    h = mix(h, isnan(rpm) ? -1L : lroundf(rpm));
+    h = mix(h, fanTachStalls());
+    h = mix(h, deci(sensorData.systemEstC));
+    h = mix(h, centi(sensorData.systemRate));
+  }
+  if (mask & SEC_SYS)
+  {
+    h = mix(h, (uint32_t)(mono_ms() / 1000));
+    h = mix(h, ESP.getFreeHeap());
+    h = mix(h, ESP.getMinFreeHeap());
+    h = mix(h, (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    h = mix(h, WiFi.isConnected());
+    h = mix(h, WiFi.RSSI());
+    h = mix(h, (uint32_t)WiFi.localIP());
+  }
+  if (mask & SEC_ALARM)
+  {
+    h = mix(h, s.alarmTriggered);
+    h = mix(h, alarmActive());
+  }
+  return h ? h : 1;   // 0 is what clients send before the first reply
+}
+
+// ============================================================
+// 🧩 Sections
+// ============================================================
+static void fillTemps(JsonObject o)
+{
+  o[F("system")] = sensorData.systemC;
+  o[F("engine")] = sensorData.engineC;
+  o[F("engine_est")] = sensorData.engineEstC;
+  o[F("engine_rate")] = sensorData.engineRate;
+  o[F("ts")] = sensorData.ts;
+}
+
+static void fillFan(JsonObject o)
+{
+  o[F("mode")] = g_settings.fan_mode == FanMode::MANUAL ? "MANUAL" : "AUTO";
+  o[F("manual_on")] = g_settings.manual_on;
+  o[F("manual_percent")] = g_settings.manual_percent;
+  o[F("target_percent")] = sensorData.targetPercent;
+  o[F("pwm_max")] = pwm_max();
+  o[F("sensorData")][F("target_pwm")] = sensorData.target_pwm;
+}
+
+static void fillSys(JsonObject o)
+{
+  char uptime[32];
+  formatUptime(uptime, sizeof(uptime));
+  o[F("uptime")] = uptime;
+  o[F("uptime_s")] = mono_ms() / 1000;
+  o[F("heap_free")] = ESP.getFreeHeap();
+  o[F("heap_min")] = ESP.getMinFreeHeap();
+  o[F("heap_largest")] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+
+  JsonObject wifi = o[F("wifi")].to<JsonObject>();
+  wifi[F("connected")] = WiFi.isConnected();
+  wifi[F("ssid")] = WiFi.SSID();
+  wifi[F("ip")] = WiFi.localIP().toString();
+  wifi[F("rssi")] = WiFi.RSSI();
+}
+
+static void fillHw(JsonObject o)
+{
+  JsonObject pins = o[F("pins")].to<JsonObject>();
+  pins[F("system_temp_pin")] = system_temp_pin;
+  pins[F("engine_temp_pin")] = engine_temp_pin;
+  pins[F("fan_control_pin")] = fan_control_pin;
+  pins[F("fan_tach_pin")] = fan_tach_pin;
+
+  JsonObject pwm = o[F("pwm")].to<JsonObject>();
+  pwm[F("channel")] = g_settings.pwm_channel;
+  pwm[F("freq_hz")] = g_settings.pwm_freq_hz;
+  pwm[F("resolution_bits")] = g_settings.pwm_resolution_bits;
+  pwm[F("invert")] = g_settings.invert_pwm;
+
+  JsonObject adc = o[F("adc")].to<JsonObject>();
+  adc[F("VREF")] = ntcConstants.VREF;
+  adc[F("ADC_MAX")] = ntcConstants.ADC_MAX;
+  adc[F("R_FIXED")] = ntcConstants.R_FIXED;
+  adc[F("NTC_BETA")] = ntcConstants.NTC_BETA;
+}
+
+static void fillLogic(JsonObject o)
+{
+  o[F("system_alert")] = g_settings.system_temp_alert;
+  o[F("min_rotation")] = g_settings.min_rotation_temp;
+  o[F("max_rotation")] = g_settings.max_rotation_temp;
+
+  JsonObject i = o[F("intervals")].to<JsonObject>();
+  i[F("temp_sample_ms")] = g_settings.temp_sample_interval_ms;
+  i[F("adc_samples")] = g_settings.adc_samples;
+  i[F("engine_read_ms")] = engine_temp_read_interval;
+  i[F("fan_control_ms")] = g_settings.fan_control_interval;
+}
+
+static void fillSettingsSection(JsonObject o)
+{
+  fillJsonFrom(g_settings, o);
+
+  JsonObject ui = o[F("ui")].to<JsonObject>();
+  ui[F("system_min")] = g_settings.ui_system_min;
+  ui[F("system_max")] = g_settings.ui_system_max;
+  ui[F("engine_min")] = g_settings.ui_engine_min;
+  ui[F("engine_max")] = g_settings.ui_engine_max;
+}
+
+static void fillAlarm(JsonObject o)
+{
+  o[F("alarmTriggered")] = g_settings.alarmTriggered;
+  o[F("active")] = alarmActive();
+}
+
+// ============================================================
+// 🌐 GET /api/status
+// ============================================================
+void apiStatus(AsyncWebServerRequest *req)
+{
+  uint16_t mask = req->hasParam("fields") ? parseFields(req->getParam("fields")->value()) : (uint16_t)SEC_ALL;
+  uint32_t gen = statusGeneration(mask);
+
+  if (req->hasParam("since") && (uint32_t)strtoul(req->getParam("since")->value().c_str(), nullptr, 10) == gen)
+  {
+    AsyncWebServerResponse *res = req->beginResponse(304);
+    res->addHeader("Cache-Control", "no-cache");
+    req->send(res);
+    return;
+  }
+
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
+  doc[F("gen")] = gen;
+
+  if (mask & SEC_TEMPS)
+    fillTemps(doc[F("temps")].to<JsonObject>());
+  if (mask & SEC_FAN)
+    fillFan(doc[F("fan")].to<JsonObject>());
+  if (mask & SEC_SYS)
+    fillSys(doc[F("sys")].to<JsonObject>());
+  if (mask & SEC_HW)
+    fillHw(doc[F("hw")].to<JsonObject>());
+  if (mask & SEC_LOGIC)
+    fillLogic(doc[F("logic")].to<JsonObject>());
+  if (mask & SEC_SETTINGS)
+    fillSettingsSection(doc[F("settings")].to<JsonObject>());
+  if (mask & SEC_SENSORS)
+    fillSensorValues(doc[F("sensors")].to<JsonObject>());
+  if (mask & SEC_ALARM)
+    fillAlarm(doc[F("alarm")].to<JsonObject>());
+
+  sendJson(req, doc);
+}
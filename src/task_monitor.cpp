@@ -0,0 +1,395 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "project_config.h"
+
+// ============================================================
+// 📈 Task monitor
+// ------------------------------------------------------------
+// A low-priority task samples every FreeRTOS task once per
+// TASK_MON_PERIOD_MS: CPU share of its core since the previous
+// sample, stack high-water mark, priority and state. Samples
+// go into a ring of TASK_MON_HISTORY entries so CPU can be
+// averaged over sliding windows (1 sample, 10, full ring).
+//
+// Core load = 100% minus the share of that core's IDLE task.
+// Unpinned tasks (core -1) are reported against the core time
+// of one CPU, so they can show up to 100% per core they used.
+//
+// CPU figures need configGENERATE_RUN_TIME_STATS in the
+// FreeRTOS build; without it only stacks/states are reported.
+// ============================================================
+#ifndef TASK_MON_PERIOD_MS
+#define TASK_MON_PERIOD_MS 1000
+#endif
+#ifndef TASK_MON_HISTORY
+#define TASK_MON_HISTORY 60     // Samples kept (60 s at the default period)
+#endif
+#ifndef TASK_MON_MAX_TASKS
+#define TASK_MON_MAX_TASKS 24
+#endif
+
+#if configUSE_TRACE_FACILITY && configGENERATE_RUN_TIME_STATS
+#define TASK_MON_RUNTIME 1
+#else
+#define TASK_MON_RUNTIME 0
+#endif
+
+static const uint8_t TASK_MON_WINDOWS[] = {1, 10, TASK_MON_HISTORY};
+
+struct TaskSlot
+{
+  TaskHandle_t handle;   // nullptr = free slot
+  char name[configMAX_TASK_NAME_LEN];
+  int8_t core;           // -1 = no affinity
+  uint8_t prio;
+  uint8_t state;         // eTaskState
+  uint32_t stackFree;    // Bytes never used
+  uint32_t lastRun;      // Run-time counter at the previous sample
+};
+
+struct TaskSample
+{
+  uint32_t ms;
+  uint16_t coreLoad[portNUM_PROCESSORS];   // Per mille
+  uint16_t cpu[TASK_MON_MAX_TASKS];         // Per mille of one core, by slot
+};
+
+static TaskSlot slots[TASK_MON_MAX_TASKS];
+static TaskSample history[TASK_MON_HISTORY];
+static uint16_t histHead = 0;    // Next write
+static uint16_t histCount = 0;
+static uint32_t lastTotal = 0;
+static uint32_t sampleUs = 0;    // Cost of the last sample
+static uint16_t untracked = 0;   // Tasks that did not fit in slots[]
+
+static TaskStatus_t statusBuf[TASK_MON_MAX_TASKS + 4];
+static SemaphoreHandle_t monMutex = nullptr;
+
+struct MonLock
+{
+  MonLock() { xSemaphoreTake(monMutex, portMAX_DELAY); }
+  ~MonLock() { xSemaphoreGive(monMutex); }
+};
+
+// ============================================================
+// 🧩 Slot bookkeeping
+// ============================================================
+static int slotFor(TaskHandle_t h)
+{
+  int freeSlot = -1;
+  for (int i = 0; i < TASK_MON_MAX_TASKS; i++)
+  {
+    if (slots[i].handle == h)
+      return i;
+    if (!slots[i].handle && freeSlot < 0)
+      freeSlot = i;
+  }
+  if (freeSlot >= 0)
+  {
+    // Fresh slot: drop whatever the previous owner left in the ring
+    for (auto &s : history)
+      s.cpu[freeSlot] = 0;
+    slots[freeSlot] = TaskSlot{};
+    slots[freeSlot].handle = h;
+  }
+  return freeSlot;
+}
+
+static int8_t affinityOf(TaskHandle_t h)
+{
+  BaseType_t core = xTaskGetAffinity(h);
+  return core == tskNO_AFFINITY ? -1 : (int8_t)core;
+}
+
+// ============================================================
+// 📸 One sample
+// ============================================================
+static void sampleTasks()
+{
+  uint32_t t0 = micros();
+  uint32_t total = 0;
+  UBaseType_t n = uxTaskGetSystemState(statusBuf, TASK_MON_MAX_TASKS + 4, &total);
+
+  MonLock lock;
+  TaskSample &s = history[histHead];
+  memset(&s, 0, sizeof(s));
+  s.ms = mono_ms();
+
+  uint32_t dTotal = total - lastTotal;
+  bool seen[TASK_MON_MAX_TASKS] = {};
+  untracked = 0;
+
+  for (UBaseType_t k = 0; k < n; k++)
+  {
+    const TaskStatus_t &st = statusBuf[k];
+    int i = slotFor(st.xHandle);
+    if (i < 0)
+    {
+      untracked++;
+      continue;
+    }
+    TaskSlot &slot = slots[i];
+    seen[i] = true;
+#if TASK_MON_RUNTIME
+    bool fresh = !slot.name[0];
+#endif
+
+    strlcpy(slot.name, st.pcTaskName, sizeof(slot.name));
+    slot.core = affinityOf(st.xHandle);
+    slot.prio = st.uxCurrentPriority;
+    slot.state = st.eCurrentState;
+    slot.stackFree = st.usStackHighWaterMark * sizeof(StackType_t);
+
+#if TASK_MON_RUNTIME
+    if (!fresh && lastTotal && dTotal)
+    {
+      uint32_t dRun = st.ulRunTimeCounter - slot.lastRun;
+      s.cpu[i] = (uint16_t)min<uint64_t>((uint64_t)dRun * 1000 / dTotal, 1000);
+    }
+    slot.lastRun = st.ulRunTimeCounter;
+#endif
+  }
+
+  // Tasks that are gone free their slot
+  for (int i = 0; i < TASK_MON_MAX_TASKS; i++)
+    if (slots[i].handle && !seen[i])
+      slots[i].handle = nullptr;
+
+#if TASK_MON_RUNTIME
+  for (int c = 0; c < portNUM_PROCESSORS; c++)
+  {
+    TaskHandle_t idle = xTaskGetIdleTaskHandleForCPU(c);
+    for (int i = 0; i < TASK_MON_MAX_TASKS; i++)
+      if (slots[i].handle == idle)
+        s.coreLoad[c] = 1000 - min<uint16_t>(s.cpu[i], 1000);
+  }
+#endif
+
+  bool valid = lastTotal != 0;
+  lastTotal = total;
+  if (valid)
+  {
+    histHead = (histHead + 1) % TASK_MON_HISTORY;
+    if (histCount < TASK_MON_HISTORY)
+      histCount++;
+  }
+  sampleUs = micros() - t0;
+}
+
+void taskMonitor(void *)
+{
+  TickType_t wake = xTaskGetTickCount();
+  for (;;)
+  {
+    sampleTasks();
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(TASK_MON_PERIOD_MS));
+  }
+}
+
+void taskMonitorInit()
+{
+  if (!monMutex)
+    monMutex = xSemaphoreCreateMutex();
+}
+
+// ============================================================
+// 🧮 Window averages (call with the lock held)
+// ============================================================
+static const TaskSample &sampleAgo(int back)
+{
+  return history[(histHead + TASK_MON_HISTORY - 1 - back) % TASK_MON_HISTORY];
+}
+
+static float avgCpu(int slot, int window)
+{
+  int n = min<int>(window, histCount);
+  if (!n)
+    return 0;
+  uint32_t sum = 0;
+  for (int b = 0; b < n; b++)
+    sum += sampleAgo(b).cpu[slot];
+  return sum / (n * 10.0f);
+}
+
+static float avgCore(int core, int window)
+{
+  int n = min<int>(window, histCount);
+  if (!n)
+    return 0;
+  uint32_t sum = 0;
+  for (int b = 0; b < n; b++)
+    sum += sampleAgo(b).coreLoad[core];
+  return sum / (n * 10.0f);
+}
+
+static const char *stateName(uint8_t st)
+{
+  static const char *names[] = {"running", "ready", "blocked", "suspended", "deleted"};
+  return st < sizeof(names) / sizeof(names[0]) ? names[st] : "?";
+}
+
+static void fillWindows(JsonObject o, float (*avg)(int, int), int index)
+{
+  for (uint8_t w : TASK_MON_WINDOWS)
+  {
+    char key[8];
+    snprintf(key, sizeof(key), "%us", (unsigned)(w * TASK_MON_PERIOD_MS / 1000));
+    o[key] = roundf(avg(index, w) * 10) / 10;
+  }
+}
+
+// ============================================================
+// 📤 /api/tasks
+// ============================================================
+void fillTaskStats(JsonDocument &doc, bool withHistory)
+{
+  if (!monMutex)
+    return;
+  MonLock lock;
+
+  doc[F("period_ms")] = TASK_MON_PERIOD_MS;
+  doc[F("samples")] = histCount;
+  doc[F("runtime_stats")] = (bool)TASK_MON_RUNTIME;
+  doc[F("sample_us")] = sampleUs;
+  if (untracked)
+    doc[F("untracked")] = untracked;
+
+  JsonArray cores = doc[F("cores")].to<JsonArray>();
+  for (int c = 0; c < portNUM_PROCESSORS; c++)
+  {
+    JsonObject o = cores.add<JsonObject>();
+    o[F("core")] = c;
+    fillWindows(o[F("load")].to<JsonObject>(), avgCore, c);
+    if (withHistory)
+    {
+      JsonArray h = o[F("history")].to<JsonArray>();
+      for (int b = histCount - 1; b >= 0; b--)
+        h.add(sampleAgo(b).coreLoad[c] / 10.0f);
+    }
+  }
+
+  JsonArray tasks = doc[F("tasks")].to<JsonArray>();
+  for (int i = 0; i < TASK_MON_MAX_TASKS; i++)
+  {
+    const TaskSlot &t = slots[i];
+    if (!t.handle)
+      continue;
+    JsonObject o = tasks.add<JsonObject>();
+    o[F("name")] = t.name;
+    o[F("core")] = t.core;
+    o[F("prio")] = t.prio;
+    o[F("state")] = stateName(t.state);
+    o[F("stack_free")] = t.stackFree;
+    fillWindows(o[F("cpu")].to<JsonObject>(), avgCpu, i);
+    if (withHistory)
+    {
+      JsonArray h = o[F("history")].to<JsonArray>();
+      for (int b = histCount - 1; b >= 0; b--)
+        h.add(sampleAgo(b).cpu[i] / 10.0f);
+    }
+  }
+}
+
+// ============================================================
+// 📊 /metrics collectors (last sample, one line per task/core)
+// ============================================================
+// i-th occupied slot, or -1 past the end
+static int activeSlot(int i)
+{
+  for (int k = 0; k < TASK_MON_MAX_TASKS; k++)
+    if (slots[k].handle && i-- == 0)
+      return k;
+  return -1;
+}
+
+static bool collectTaskCpu(int i, char *labels, size_t n, float &value)
+{
+  if (!monMutex)
+    return false;
+  MonLock lock;
+  int k = activeSlot(i);
+  if (k < 0)
+    return false;
+  snprintf(labels, n, "task=\"%s\",core=\"%d\"", slots[k].name, slots[k].core);
+  value = avgCpu(k, TASK_MON_WINDOWS[0]);
+  return true;
+}
+
+static bool collectTaskStack(int i, char *labels, size_t n, float &value)
+{
+  if (!monMutex)
+    return false;
+  MonLock lock;
+  int k = activeSlot(i);
+  if (k < 0)
+    return false;
+  snprintf(labels, n, "task=\"%s\"", slots[k].name);
+  value = slots[k].stackFree;
+  return true;
+}
+
+static bool collectCoreLoad(int i, char *labels, size_t n, float &value)
+{
+  if (i >= portNUM_PROCESSORS || !monMutex)
+    return false;
+  MonLock lock;
+  snprintf(labels, n, "core=\"%d\"", i);
+  value = avgCore(i, TASK_MON_WINDOWS[0]);
+  return true;
+}
+
+static MetricCollector mTaskCpu("task_cpu_percent", "CPU share of one core over the last sample", MetricType::GAUGE, collectTaskCpu);
+static MetricCollector mTaskStack("task_stack_free_bytes", "Stack never used (high-water mark)", MetricType::GAUGE, collectTaskStack);
+static MetricCollector mCoreLoad("cpu_core_load_percent", "Core load over the last sample", MetricType::GAUGE, collectCoreLoad);
+
+// ============================================================
+// 🖥️ Console `tasks`
+// ============================================================
+String taskMonitorReport()
+{
+  if (!monMutex)
+    return "Task monitor not started";
+  MonLock lock;
+
+  String out = "=== tasks (" + String(histCount) + " samples @ " + String(TASK_MON_PERIOD_MS) + " ms, sample " + String(sampleUs) + " us) ===\n";
+  char line[112];
+
+#if TASK_MON_RUNTIME
+  for (int c = 0; c < portNUM_PROCESSORS; c++)
+  {
+    snprintf(line, sizeof(line), "core%d load %5.1f%% %5.1f%% %5.1f%% (last sample / 10 / all)\n", c,
+             avgCore(c, TASK_MON_WINDOWS[0]), avgCore(c, TASK_MON_WINDOWS[1]), avgCore(c, TASK_MON_WINDOWS[2]));
+    out += line;
+  }
+#else
+  out += "(no run-time stats in this FreeRTOS build: CPU columns are 0)\n";
+#endif
+
+  // Busiest first over the middle window
+  int order[TASK_MON_MAX_TASKS];
+  int n = 0;
+  for (int i = 0; i < TASK_MON_MAX_TASKS; i++)
+    if (slots[i].handle)
+      order[n++] = i;
+  std::sort(order, order + n, [](int a, int b)
+            { return avgCpu(a, TASK_MON_WINDOWS[1]) > avgCpu(b, TASK_MON_WINDOWS[1]); });
+
+  char win[3][8];
+  for (int w = 0; w < 3; w++)
+    snprintf(win[w], sizeof(win[w]), "%us", (unsigned)(TASK_MON_WINDOWS[w] * TASK_MON_PERIOD_MS / 1000));
+  snprintf(line, sizeof(line), "%-16s %4s %4s %-9s %6s %6s %6s %6s\n",
+           "NAME", "CORE", "PRIO", "STATE", "STACK", win[0], win[1], win[2]);
+  out += line;
+  for (int k = 0; k < n; k++)
+  {
+    const TaskSlot &t = slots[order[k]];
+    snprintf(line, sizeof(line), "%-16s %4d %4u %-9s %6lu %5.1f%% %5.1f%% %5.1f%%\n",
+             t.name, t.core, t.prio, stateName(t.state), (unsigned long)t.stackFree,
+             avgCpu(order[k], TASK_MON_WINDOWS[0]), avgCpu(order[k], TASK_MON_WINDOWS[1]),
+             avgCpu(order[k], TASK_MON_WINDOWS[2]));
+    out += line;
+  }
+  if (untracked)
+    out += String(untracked) + " task(s) not tracked (raise TASK_MON_MAX_TASKS)\n";
+  return out;
+}
@@ -11,6 +11,7 @@ void taskSensors(void *) {
     for (;;) {
         read_engine_temp();       // Read Dallas sensor (engine temp)
         read_system_temp();       // Read analog NTC (system temp)
+        tempFusionPublish(sensorData);                 // Estimates + rate of rise
         xQueueOverwrite(sensorDataQueue, &sensorData); // Keep only latest values
         vTaskDelay(pdMS_TO_TICKS(10));                 // Run every 10 ms
     }
@@ -38,32 +39,14 @@ void taskControl(void *pvParameters) {
 
         // Run control logic at configured intervals
         if (millis() - fan_timer >= g_settings.fan_control_interval) {
+            PROFILE_SCOPE("taskControl.compute");
+            float dtS = (millis() - fan_timer) / 1000.0f;
             fan_timer = millis();
 
-            // --- Safety Check ---
-            if (s.systemC > g_settings.system_temp_alert) {
-                sensorData.targetPercent = 0;
-                sensorData.target_pwm = 0;
-            }
-
-            // --- Automatic Mode ---
-            else if (g_settings.fan_mode == FanMode::AUTO) {
-                float ratio = (s.engineC - (float)g_settings.min_rotation_temp) /
-                              ((float)g_settings.max_rotation_temp - (float)g_settings.min_rotation_temp);
-                ratio = constrain(ratio, 0.0f, 1.0f);
-
-                sensorData.targetPercent = lroundf(ratio * 100.0f);
-                sensorData.target_pwm = lroundf(ratio * pwm_max()); // pwm_max() = 4095 at 12 bits
-            }
-
-            // --- Manual Mode ---
-            else {
-                sensorData.targetPercent = g_settings.manual_on ? g_settings.manual_percent : 0;
-                sensorData.target_pwm = lroundf((sensorData.targetPercent / 100.0f) * pwm_max());
-            }
-
-            // Apply new PWM value
-            ledcWrite(g_settings.pwm_channel, sensorData.target_pwm);
+            // All zones in one pass: safety cut, AUTO curve / MANUAL,
+            // limits, then a ramp toward the new duties; zone 0 is
+            // mirrored into sensorData
+            fanZonesTick(s, dtS);
 
             // // Log unified fan status
             // LOGI("[FAN] mode=%s pct=%d pwm=%d/%d",
@@ -73,6 +56,8 @@ void taskControl(void *pvParameters) {
             //      pwm_max());
         }
 
+        fanTachUpdate();               // Tach counter -> RPM, stall check
+        fanOutputPoll();               // Ends a start boost on time
         vTaskDelay(pdMS_TO_TICKS(20)); // Loop every 20 ms
     }
 }
@@ -0,0 +1,89 @@
+#include <Arduino.h>
+#include "project_config.h"
+#include "temp_filter.h"
+
+// ============================================================
+// 🌡️ Temperature estimates (Kalman) and control temperature
+// ------------------------------------------------------------
+// One TempKalman per channel, fed from taskSensors:
+// - engine: DS18B20 readings with their conversion age
+//   (request -> read, ~750 ms); with temp_fuse_ntc also the NTC,
+//   for installs where the NTC sits on the same coolant loop;
+// - system: the NTC on the controller board.
+//
+// tempFusionPublish() writes the estimate and the rate of rise
+// of both channels into sensorData, so taskControl receives
+// them with the raw readings through the queue.
+//
+// tempControl() is what the fan zones follow: the estimate
+// temp_predict_s seconds ahead, or the raw reading with
+// temp_filter_enabled off. NaN means no usable reading; the
+// zones then hold their output (see fan_zones.cpp).
+// ============================================================
+#ifndef TEMP_VAR_DS18B20
+#define TEMP_VAR_DS18B20 0.01f   // °C², 0.1 °C noise + 0.0625 °C steps
+#endif
+#ifndef TEMP_VAR_NTC
+#define TEMP_VAR_NTC 0.25f       // °C², 0.5 °C ADC noise
+#endif
+
+static TempKalman engineKf;
+static TempKalman systemKf;
+
+void tempFusionConfigure()
+{
+  engineKf.staleMs = g_settings.temp_stale_ms;
+  systemKf.staleMs = g_settings.temp_stale_ms;
+}
+
+void tempFusionEngine(float c, uint32_t ageMs)
+{
+  engineKf.update(c, TEMP_VAR_DS18B20, millis(), ageMs / 1000.0f);
+}
+
+void tempFusionSystem(float c)
+{
+  uint32_t now = millis();
+  systemKf.update(c, TEMP_VAR_NTC, now);
+  if (g_settings.temp_fuse_ntc)
+    engineKf.update(c, TEMP_VAR_NTC, now);
+}
+
+// taskSensors, every pass
+void tempFusionPublish(SystemInfo &d)
+{
+  uint32_t now = millis();
+  d.engineEstC = engineKf.at(now);
+  d.engineRate = engineKf.rate(now);
+  d.systemEstC = systemKf.at(now);
+  d.systemRate = systemKf.rate(now);
+}
+
+float tempControl(const SystemInfo &in, ZoneSensor sensor)
+{
+  bool system = sensor == ZoneSensor::SYSTEM;
+  if (!g_settings.temp_filter_enabled)
+    return system ? in.systemC : in.engineC;
+
+  float est = system ? in.systemEstC : in.engineEstC;
+  float rate = system ? in.systemRate : in.engineRate;
+  return est + rate * g_settings.temp_predict_s;   // NaN stays NaN
+}
+
+void fillFusion(JsonObject o)
+{
+  o[F("enabled")] = g_settings.temp_filter_enabled;
+  o[F("horizon_s")] = g_settings.temp_predict_s;
+  o[F("engine")] = sensorData.engineEstC;
+  o[F("engine_rate")] = sensorData.engineRate;
+  o[F("engine_sigma")] = engineKf.sigma();
+  o[F("system")] = sensorData.systemEstC;
+  o[F("system_rate")] = sensorData.systemRate;
+}
+
+static MetricGauge mEngineEst("engine_temperature_estimate_celsius", "Kalman estimate of the engine temperature, NaN when stale",
+                              []() -> float { return sensorData.engineEstC; });
+static MetricGauge mEngineRate("engine_temperature_rate_celsius_per_second", "Estimated rate of rise of the engine temperature",
+                               []() -> float { return sensorData.engineRate; });
+static MetricGauge mSystemEst("system_temperature_estimate_celsius", "Kalman estimate of the board temperature, NaN when stale",
+                              []() -> float { return sensorData.systemEstC; });
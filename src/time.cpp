@@ -1,25 +1,6 @@
 #include "project_config.h"
 
 static tm timeinfo;        // Cached time structure
-static bool timeSynced = false;  // Indicates if NTP sync was successful
-
-// =======================================================
-// 🕒 Initialize NTP time synchronization
-// =======================================================
-void initTime(const char *ntpServer, long gmtOffset_sec, int daylightOffset_sec) {
-    LOGI("⏳ Initializing time with NTP server: %s", ntpServer);
-
-    configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
-
-    if (!getLocalTime(&timeinfo, 200)) {
-        LOGW("⚠️ NTP not yet available — falling back to millis() until sync...");
-        timeSynced = false;
-        return;
-    }
-
-    timeSynced = true;
-    LOGI("✅ Time synchronized: %s", getDateTime().c_str());
-}
 
 // =======================================================
 // 📅 Return current time as a tm struct
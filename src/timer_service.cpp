@@ -0,0 +1,68 @@
+#include <Arduino.h>
+#include "project_config.h"
+
+// ============================================================
+// ⏲️ Timer service task
+// ------------------------------------------------------------
+// Advances timerWheel to millis(), runs whatever is due, then
+// sleeps until the wheel's next fire/cascade point. Adding a
+// timer notifies the task so a shorter delay is picked up
+// immediately.
+// ============================================================
+ServiceTimerWheel timerWheel;
+
+static volatile uint32_t timerWakeups = 0;
+static uint32_t timerBusyUs = 0;    // Time spent advancing the wheel
+static uint32_t timerLongestUs = 0; // Longest single advance
+
+void timerServiceWake()
+{
+  if (!hTimers)
+    return;   // Task not started yet; it syncs on its first pass
+
+  if (xPortInIsrContext())
+  {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(hTimers, &woken);
+    if (woken)
+      portYIELD_FROM_ISR();
+  }
+  else
+    xTaskNotifyGive(hTimers);
+}
+
+void taskTimers(void *)
+{
+  for (;;)
+  {
+    uint32_t t0 = micros();
+    timerWheel.advance(millis());
+    uint32_t us = micros() - t0;
+    timerBusyUs += us;
+    if (us > timerLongestUs)
+      timerLongestUs = us;
+
+    uint32_t sleepMs = min<uint32_t>(timerWheel.nextDue(), TIMER_SERVICE_MAX_SLEEP_MS);
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
+    timerWakeups++;
+  }
+}
+
+// ============================================================
+// 📊 Console `timers`
+// ============================================================
+String timerReport()
+{
+  auto st = timerWheel.stats();
+  char buf[256];
+  snprintf(buf, sizeof(buf),
+           "=== timers ===\n"
+           "active=%u/%u high_water=%u fired=%lu cancelled=%lu cascaded=%lu pool_full=%lu\n"
+           "next_due=%lums wakeups=%lu busy=%lums longest=%luus\n",
+           st.active, ServiceTimerWheel::capacity(), st.highWater,
+           (unsigned long)st.fired, (unsigned long)st.cancelled,
+           (unsigned long)st.cascaded, (unsigned long)st.poolFull,
+           (unsigned long)timerWheel.nextDue(), (unsigned long)timerWakeups,
+           (unsigned long)(timerBusyUs / 1000), (unsigned long)timerLongestUs);
+  return buf;
+}
@@ -7,6 +7,9 @@
 // =======================================================
 void initServer()
 {
+  // --- Request accounting: must see every request first ---
+  routeStatsInit(server);
+
   // --- Dynamic API routes ---
   std::vector<Route> urlpatterns = {
       {"/deleteFile", HTTP_POST, deleteFile},
@@ -15,6 +18,7 @@ void initServer()
       {"/sysinfo", HTTP_GET, sysInfo},
       {"/get_settings", HTTP_GET, get_settings},
       {"/files_list", HTTP_GET, files_list},
+      {"/api/files", HTTP_GET, apiFiles},
       {"/wifi_info", HTTP_GET, wifi_info},
       {"/restart", HTTP_GET, web_restart},
       {"/alarma", HTTP_GET, alarma},
@@ -29,34 +33,22 @@ void initServer()
       {"/toggle_fan", HTTP_GET, toggleFan},
       {"/settings", HTTP_GET, settings},
       {"/api/settings/defaults", HTTP_GET, apiSettingsDefault},
+      {"/api/settings", HTTP_GET, apiSettings},
+      {"/api/sensors", HTTP_GET, apiSensors},
+      {"/api/zones", HTTP_GET, apiZones},
+      {"/api/status", HTTP_GET, apiStatus},
+      {"/api/tasks", HTTP_GET, apiTasks},
+      {"/api/profile", HTTP_GET, apiProfile},
+      {"/api/route_stats", HTTP_GET, apiRouteStats},
+      {"/metrics", HTTP_GET, handleMetrics},
       {"/set_mode", HTTP_GET, setMode},
       {"/fan", HTTP_GET, fan},
       {"/favicon.ico", HTTP_GET, favicon},
       {"/status", HTTP_GET, handleJson}};
 
-  // --- GET: /api/settings ---
-  server.on("/api/settings", HTTP_GET, [](AsyncWebServerRequest *req) {
-    req->send(200, "application/json", settingsToJson(g_settings));
-  });
-
-  // --- GET: /api/sensors ---
-  server.on("/api/sensors", HTTP_GET, [](AsyncWebServerRequest *req) {
-    LOGI("📡 GET /api/sensors called");
-    JsonDocument doc;
-    doc["systemC"] = sensorData.systemC;
-    doc["engineC"] = sensorData.engineC;
-    doc["ts"] = sensorData.ts;
-    doc["manual_percent"] = g_settings.manual_percent;
-    doc["targetPercent"] = sensorData.targetPercent;
-    doc["target_pwm"] = sensorData.target_pwm;
-    String json;
-    serializeJson(doc, json);
-    req->send(200, "application/json", json);
-  });
-
   // --- POST: /api/settings ---
   server.on("/api/settings", HTTP_POST, [](AsyncWebServerRequest *req) {}, NULL,
-            [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total) {
+            timedView("/api/settings", HTTP_POST, [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t index, size_t total) {
               static String body;
               if (index == 0)
                 body = "";
@@ -72,46 +64,48 @@ void initServer()
                 }
                 req->send(ok ? 200 : 400, "application/json", ok ? "{\"ok\":true}" : "{\"ok\":false}");
               }
-            });
+            }));
 
   // --- POST: /send_sms ---
-  server.on("/send_sms", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL, sendSmsView);
+  server.on("/send_sms", HTTP_POST, [](AsyncWebServerRequest *request) {}, NULL,
+            timedView("/send_sms", HTTP_POST, sendSmsView));
 
   // --- POST: /set_pwm_freq ---
-  server.on("/set_pwm_freq", HTTP_POST, [](AsyncWebServerRequest *request) {
+  server.on("/set_pwm_freq", HTTP_POST, timedView("/set_pwm_freq", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!request->hasParam("freq"))
     {
-      request->send(400, "text/plain", "❌ Missing parameter 'freq'");
+      sendConst(request, 400, "text/plain", "❌ Missing parameter 'freq'");
       return;
     }
     int newFreq = request->getParam("freq")->value().toInt();
     if (newFreq <= 0)
     {
-      request->send(400, "text/plain", "⚠️ Invalid frequency value");
+      sendConst(request, 400, "text/plain", "⚠️ Invalid frequency value");
       return;
     }
 
     uint32_t realFreq = ledcChangeFrequency(g_settings.pwm_channel, newFreq, g_settings.pwm_resolution_bits);
     if (realFreq == 0)
     {
-      request->send(500, "text/plain", "❌ Error changing frequency");
+      sendConst(request, 500, "text/plain", "❌ Error changing frequency");
       return;
     }
 
     g_settings.pwm_freq_hz = realFreq;
     settingsSaveToFS();
 
-    static char buf[256];
-    snprintf(buf, sizeof(buf), "✅ Frequency set: %lu Hz, resolution: %u bits",
-             (unsigned long)realFreq, g_settings.pwm_resolution_bits);
-    request->send(200, "text/plain", buf);
-  });
+    JsonArenaScope arena;
+    TextBuilder out(arena, 64);
+    out.printf("✅ Frequency set: %lu Hz, resolution: %u bits",
+               (unsigned long)realFreq, g_settings.pwm_resolution_bits);
+    sendText(request, 200, "text/plain", out);
+  }));
 
   // --- POST: /set_manual_percent ---
-  server.on("/set_manual_percent", HTTP_POST, [](AsyncWebServerRequest *request) {
+  server.on("/set_manual_percent", HTTP_POST, timedView("/set_manual_percent", HTTP_POST, [](AsyncWebServerRequest *request) {
     if (!request->hasParam("value"))
     {
-      request->send(400, "text/plain", "❌ Missing parameter 'value'");
+      sendConst(request, 400, "text/plain", "❌ Missing parameter 'value'");
       return;
     }
 
@@ -122,14 +116,15 @@ void initServer()
     g_settings.manual_on = (val > 0);
     settingsSaveToFS();
 
-    static char buf[256];
-    snprintf(buf, sizeof(buf), "✅ Manual speed set to %d%% (PWM=%d)", val, sensorData.target_pwm);
-    request->send(200, "text/plain", buf);
-  });
+    JsonArenaScope arena;
+    TextBuilder out(arena, 48);
+    out.printf("✅ Manual speed set to %d%% (PWM=%d)", val, sensorData.target_pwm);
+    sendText(request, 200, "text/plain", out);
+  }));
 
   // --- POST: /cmd (serial command passthrough) ---
   server.on("/cmd", HTTP_POST, [](AsyncWebServerRequest *req) {}, NULL,
-            [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t, size_t) {
+            timedView("/cmd", HTTP_POST, [](AsyncWebServerRequest *req, uint8_t *data, size_t len, size_t, size_t) {
               String input((char *)data, len);
               input.trim();
 
@@ -138,27 +133,22 @@ void initServer()
               LOGI("%s", out.c_str());
 
               req->send(200, "text/plain", out);
-            });
+            }));
 
   // --- POST: /firmware_update (OTA firmware upload) ---
-  server.on("/firmware_update", HTTP_POST, [](AsyncWebServerRequest *request) {
-    LOGI("-> OTA update route /firmware_update");
-    request->send(200, "text/plain", "Firmware updated successfully!");
-  },
-            handleUpdateFirmware);
+  server.on("/firmware_update", HTTP_POST, timedView("/firmware_update", HTTP_POST, otaUploadDone), handleUpdateFirmware);
 
   // --- POST: /updatefs (LittleFS OTA upload) ---
-  server.on("/updatefs", HTTP_POST, [](AsyncWebServerRequest *request) {
-    request->send(200, "text/plain", "✅ LittleFS updated successfully!");
-    LOGI("LittleFS upload finished");
-  },
-            handleUpdateLittleFS);
+  server.on("/updatefs", HTTP_POST, timedView("/updatefs", HTTP_POST, otaUploadDone), handleUpdateLittleFS);
+
+  // --- POST: /firmware_delta (delta patch against the running firmware) ---
+  server.on("/firmware_delta", HTTP_POST, timedView("/firmware_delta", HTTP_POST, otaUploadDone), handleUpdateDelta);
 
   // --- Dynamic routes ---
   for (auto &route : urlpatterns)
   {
     LOGI("✅ Added route: %s (method=%d)", route.path.c_str(), route.method);
-    server.on(route.path.c_str(), route.method, route.view);
+    server.on(route.path.c_str(), route.method, timedView(route.path.c_str(), route.method, route.view));
   }
 
   // --- Static routes ---
@@ -181,6 +171,7 @@ void initServer()
 
   for (auto &route : staticroutes)
   {
+    routeStatsSlot(route.url.c_str(), HTTP_GET);
     server.serveStatic(route.url.c_str(), LittleFS, route.file.c_str())
         .setCacheControl("max-age=86400");
   }
@@ -37,12 +37,11 @@ static inline const __FlashStringHelper *fanModeName(FanMode m)
 }
 
 // Format uptime into a readable string (e.g., "1d 2h 30m 5s")
-static void formatUptime(char *buf, size_t n)
+void formatUptime(char *buf, size_t n)
 {
-  uint32_t ms = millis();
-  uint32_t s = ms / 1000;
-  uint32_t d = s / 86400;
-  s %= 86400;
+  uint64_t s64 = mono_ms() / 1000;
+  uint32_t d = s64 / 86400;
+  uint32_t s = s64 % 86400;
   uint32_t h = s / 3600;
   s %= 3600;
   uint32_t m = s / 60;
@@ -63,6 +62,7 @@ void registerCommand(const String &name, std::function<String(String)> handler)
 // Process a command string (e.g., "set hostname mydevice")
 String processCommand(const String &input)
 {
+  PROFILE_SCOPE("processCommand");
   int spaceIdx = input.indexOf(' ');
   String cmd = (spaceIdx == -1) ? input : input.substring(0, spaceIdx);
   String args = (spaceIdx == -1) ? "" : input.substring(spaceIdx + 1);
@@ -130,10 +130,12 @@ void initCommands()
         String val = args.substring(sp + 1);
         if (var == "manual_percent") {
             g_settings.manual_percent = val.toInt();
+            settingsTouch();
             return "✅ manual_percent=" + String(g_settings.manual_percent);
         }
         if (var == "hostname") {
             g_settings.hostname = val;
+            settingsTouch();
             return "✅ hostname=" + g_settings.hostname;
         }
         return "Unknown variable!"; });
@@ -141,8 +143,8 @@ void initCommands()
   // --- FAN MODE ---
   registerCommand("fan_mode", [](String args) -> String
                   {
-        if (args == "auto") { g_settings.fan_mode = FanMode::AUTO; return "Fan mode=AUTO"; }
-        if (args == "manual") { g_settings.fan_mode = FanMode::MANUAL; return "Fan mode=MANUAL"; }
+        if (args == "auto") { g_settings.fan_mode = FanMode::AUTO; settingsTouch(); return "Fan mode=AUTO"; }
+        if (args == "manual") { g_settings.fan_mode = FanMode::MANUAL; settingsTouch(); return "Fan mode=MANUAL"; }
         return "Usage: fan_mode auto/manual"; });
 
   // --- MANUAL PWM SET ---
@@ -150,16 +152,73 @@ void initCommands()
                   {
         int val = args.toInt();
         sensorData.target_pwm = constrain(val, 0, pwm_max());
-        ledcWrite(g_settings.pwm_channel, sensorData.target_pwm);
-        return "PWM=" + String(sensorData.target_pwm); });
+        fanOutputSet(0, sensorData.target_pwm);
+        return "PWM=" + String(sensorData.target_pwm) + (fanOutputBoosting(0) ? " (boost)" : ""); });
+
+  // --- FAN ZONES ---
+  registerCommand("zones", [](String args) -> String
+                  { return fanZonesReport(); });
 
   // --- HEAP INFO ---
   registerCommand("heap", [](String args) -> String
-                  { return "Free heap=" + String(ESP.getFreeHeap()); });
+                  { return heapTrendReport(); });
+
+  // --- JSON ENDPOINT STATS ---
+  registerCommand("json_stats", [](String args) -> String
+                  { return jsonStatsReport(); });
+
+  // --- JSON POOL USAGE ---
+  registerCommand("json_pool", [](String args) -> String
+                  { return jsonPoolReport(); });
+
+  // --- JSON SERIALIZATION BENCHMARK ---
+  registerCommand("bench_json", [](String args) -> String
+                  { return jsonBenchReport(args.toInt()); });
+
+  // --- WIRE FORMAT BENCHMARK (JSON vs MessagePack) ---
+  registerCommand("bench_fmt", [](String args) -> String
+                  { return formatBenchReport(args.toInt()); });
+
+  // --- BACKGROUND OTA ---
+  registerCommand("ota_pull", [](String args) -> String
+                  { return otaPullReport(); });
+
+  registerCommand("ota_check", [](String args) -> String
+                  {
+    otaPullNow();
+    return "Manifest check queued"; });
 
   // --- CURRENT TIME ---
   registerCommand("time", [](String args) -> String
-                  { return "Current time=" + getDateTime(); });
+                  { return timeReport(); });
+
+  // --- HTTP ROUTE STATS ---
+  registerCommand("routes", [](String args) -> String
+                  {
+    if (args == "reset")
+    {
+      routeStatsReset();
+      return "✅ Route counters cleared";
+    }
+    return routeStatsReport(); });
+
+  // --- SCOPE PROFILER ---
+  registerCommand("profile", [](String args) -> String
+                  {
+    if (args == "reset")
+    {
+      profileReset();
+      return "✅ Profile counters cleared";
+    }
+    return profileReport(); });
+
+  // --- TASK CPU / STACK ---
+  registerCommand("tasks", [](String args) -> String
+                  { return taskMonitorReport(); });
+
+  // --- TIMER SERVICE ---
+  registerCommand("timers", [](String args) -> String
+                  { return timerReport(); });
 
   // --- SYSTEM UPTIME ---
   registerCommand("uptime", [](String args) -> String
@@ -171,9 +230,7 @@ void initCommands()
   // --- CLEAR LOG BUFFER ---
   registerCommand("clear_log", [](String args) -> String
                   {
-        logBufferSetup = "";
-        memset(logBufferRuntime, 0, sizeof(logBufferRuntime));
-        logHead = 0;
+        clearLog();
         return "✅ Log cleared"; });
 
   // --- RESTART DEVICE ---
@@ -214,6 +271,10 @@ void initCommands()
         }
         return "❌ Connection failed!"; });
 
+  // --- WI-FI TIME-TO-CONNECT METRICS ---
+  registerCommand("wifi_stats", [](String args) -> String
+                  { return wifiStatsReport(); });
+
   // --- CLEAR STORED WI-FI NETWORKS ---
   registerCommand("wifi_clear", [](String args) -> String
                   {
@@ -230,7 +291,8 @@ void initCommands()
 // -------- JSON Helpers --------
 bool settingsFromJson(const String &json)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   auto err = deserializeJson(doc, json);
   if (err)
   {
@@ -244,7 +306,8 @@ bool settingsFromJson(const String &json)
 
 String settingsToJson(const SystemSettings &s)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   fillJsonFrom(s, doc);
   String out;
   serializeJson(doc, out);
@@ -361,12 +424,11 @@ void initADC()
   delay(10);
 }
 
+// All zone channels, zone 0 included, are rebuilt by fan_zones.cpp:
+// right away at boot, by taskControl once it runs (fades may be active)
 void reinitPwm(int channel, int freq_hz, int resolution_bits, bool invert)
 {
-  ledcDetachPin(fan_control_pin);
-  ledcSetup(g_settings.pwm_channel, g_settings.pwm_freq_hz, g_settings.pwm_resolution_bits);
-  ledcAttachPin(fan_control_pin, g_settings.pwm_channel);
-  ledcWrite(channel, 0);
+  fanZonesInitPwm();
 }
 
 // -------- Send WhatsApp via CallMeBot --------
@@ -406,7 +468,7 @@ void applyManualFan(bool on, uint8_t percent)
     sensorData.target_pwm = 0;
   }
 
-  ledcWrite(g_settings.pwm_channel, sensorData.target_pwm);
+  // taskControl ramps the output there on its next tick
   LOGI("[FAN] mode=%s pct=%u pwm=%d/%d",
        (g_settings.fan_mode == FanMode::AUTO ? "AUTO" : "MANUAL"),
        percent,
@@ -440,6 +502,30 @@ bool canInit(uint32_t bitRate)
   return true;
 }
 
+// Driver status for /metrics; all zero while the driver is not installed
+static twai_status_info_t canStatus()
+{
+  twai_status_info_t st = {};
+  twai_get_status_info(&st);
+  return st;
+}
+
+static MetricCounter mCanRx("can_frames", "CAN frames", "dir=\"rx\"");
+static MetricCounter mCanTxFailed("can_frames", "CAN frames",
+                                  []() -> uint32_t { return canStatus().tx_failed_count; }, "dir=\"tx_failed\"");
+static MetricCounter mCanRxMissed("can_frames", "CAN frames",
+                                  []() -> uint32_t { return canStatus().rx_missed_count; }, "dir=\"rx_missed\"");
+static MetricCounter mCanBusErrors("can_bus_errors", "CAN bus errors",
+                                   []() -> uint32_t { return canStatus().bus_error_count; });
+static MetricCounter mCanArbLost("can_arbitration_lost", "CAN arbitration losses",
+                                 []() -> uint32_t { return canStatus().arb_lost_count; });
+static MetricGauge mCanTec("can_error_counter", "TWAI error counters (TEC/REC)",
+                           []() -> float { return canStatus().tx_error_counter; }, "dir=\"tx\"");
+static MetricGauge mCanRec("can_error_counter", "TWAI error counters (TEC/REC)",
+                           []() -> float { return canStatus().rx_error_counter; }, "dir=\"rx\"");
+static MetricGauge mCanState("can_state", "TWAI state: 0 stopped, 1 running, 2 bus-off, 3 recovering",
+                             []() -> float { return canStatus().state; });
+
 void taskCan(void *pvParameters)
 {
   twai_message_t msg;
@@ -448,8 +534,9 @@ void taskCan(void *pvParameters)
   {
     if (twai_receive(&msg, pdMS_TO_TICKS(50)) == ESP_OK)
     {
+      mCanRx.inc();
       LOGI("=== CAN FRAME RECEIVED ===");
-      LOGI("ID: 0x%08X (%u)", msg.identifier, msg.identifier);
+      LOGI("ID: 0x%08X (%u)", (unsigned)msg.identifier, (unsigned)msg.identifier);
       LOGI("DLC: %d", msg.data_length_code);
 
       for (int i = 0; i < msg.data_length_code; i++)
@@ -475,30 +562,13 @@ void setLed(uint8_t r, uint8_t g, uint8_t b)
   FastLED.show();
 }
 
-// -------- Timed Function Execution --------
-bool setInterval(unsigned long intervalMs, void (*fn)())
-{
-  static unsigned long lastCall[20];
-  static int counter = 0;
-
-  int id = counter++;
-  unsigned long now = millis();
-
-  if (now - lastCall[id] >= intervalMs)
-  {
-    lastCall[id] = now;
-    fn();
-    return true;
-  }
-  return false;
-}
-
 // -------- Temperature Readings --------
 void read_system_temp()
 {
   static uint32_t system_temp_timer = 0;
   if (millis() - system_temp_timer >= system_temp_read_interval)
   {
+    PROFILE_SCOPE("read_system_temp");
     uint16_t raw = analogRead(system_temp_pin);
     float voltage = (raw * ntcConstants.VREF) / ntcConstants.ADC_MAX;
     const float eps = 0.0001;
@@ -506,7 +576,12 @@ void read_system_temp()
     float r_ntc = (voltage * ntcConstants.R_FIXED) / denom;
     float invT = (1.0 / ntcConstants.NTC_T0K) +
                  (1.0 / ntcConstants.NTC_BETA) * log(r_ntc / ntcConstants.NTC_R0);
-    sensorData.systemC = (1.0 / invT) - 273.15;
+    // Open or shorted NTC: no reading rather than -273 / +inf
+    if (raw == 0 || raw >= ntcConstants.ADC_MAX)
+      sensorData.systemC = NAN;
+    else
+      sensorData.systemC = (1.0 / invT) - 273.15;
+    tempFusionSystem(sensorData.systemC);
     system_temp_timer = millis();
   }
 }
@@ -518,6 +593,7 @@ void read_engine_temp()
 
   if (!tempRequested && (millis() - engine_temp_read_timer >= engine_temp_read_interval))
   {
+    PROFILE_SCOPE("read_engine_temp.request");
     dallas.requestTemperatures();
     tempRequested = true;
     engine_temp_read_timer = millis();
@@ -525,10 +601,12 @@ void read_engine_temp()
 
   if (tempRequested && (millis() - engine_temp_read_timer >= 750))
   {
+    PROFILE_SCOPE("read_engine_temp.read");
     float temp = dallas.getTempCByIndex(0);
     if (temp != DEVICE_DISCONNECTED_C)
     {
       sensorData.engineC = temp;
+      tempFusionEngine(temp, millis() - engine_temp_read_timer);   // Value dates from the request
     }
     else
     {
@@ -540,6 +618,20 @@ void read_engine_temp()
 }
 
 // -------- System Info Logging --------
+// Multi-line reports go out one record per line: logMessage()
+// formats into a 256-byte buffer and would cut them short.
+static void logLines(const String &text)
+{
+  const char *p = text.c_str();
+  while (*p)
+  {
+    const char *nl = strchr(p, '\n');
+    int len = nl ? nl - p : strlen(p);
+    LOGI("%.*s", len, p);
+    p += len + (nl ? 1 : 0);
+  }
+}
+
 void logSystemInfo()
 {
   LOGI("");
@@ -551,19 +643,15 @@ void logSystemInfo()
        heap_caps_get_free_size(MALLOC_CAP_8BIT) / (1024.0 * 1024));
   LOGI("Free IRAM: %.2f MB",
        heap_caps_get_free_size(MALLOC_CAP_32BIT) / (1024.0 * 1024));
+  logLines(jsonPoolReport());
 
-  LOGI("Stack high water mark (control): %.2f KB",
-       uxTaskGetStackHighWaterMark(hControl) * sizeof(StackType_t) / 1024.0);
-  LOGI("Stack high water mark (sensors): %.2f KB",
-       uxTaskGetStackHighWaterMark(hSensors) * sizeof(StackType_t) / 1024.0);
-  LOGI("Stack high water mark (CAN): %.2f KB",
-       uxTaskGetStackHighWaterMark(hCan) * sizeof(StackType_t) / 1024.0);
+  logLines(taskMonitorReport());
 
   esp_chip_info_t chip_info;
   esp_chip_info(&chip_info);
   LOGI("Chip model: %d, cores: %d, features: %d",
-       chip_info.model, chip_info.cores, chip_info.features);
-  LOGI("CPU freq: %d MHz", getCpuFrequencyMhz());
+       chip_info.model, chip_info.cores, (int)chip_info.features);
+  LOGI("CPU freq: %d MHz", (int)getCpuFrequencyMhz());
   LOGI("Flash size: %.2f MB", ESP.getFlashChipSize() / (1024.0 * 1024));
   LOGI("");
 }
@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <ESPAsyncWebServer.h>
-#include <Update.h>
 #include "project_config.h"
 #include <ArduinoJson.h>
 
@@ -53,7 +52,7 @@ void fillJson(JsonDocument &json)
   json[F("temperature")] = sensorData.systemC;
   json[F("free_heap")] = ESP.getFreeHeap();
   json[F("status")] = F("on");
-  json[F("uptime_seconds")] = millis() / 1000;
+  json[F("uptime_seconds")] = mono_ms() / 1000;
   json[F("reset_reason")] = getResetReason();
   json[F("cpu_frequency")] = getCpuFrequencyMhz();
   json[F("flash_size")] = ESP.getFlashChipSize();
@@ -77,8 +76,7 @@ void sysInfo(AsyncWebServerRequest *req)
 // ============================================================
 void handleClearLog(AsyncWebServerRequest *request)
 {
-  memset(logBufferRuntime, 0, LOG_BUFFER_SIZE);
-  logHead = 0;
+  clearLog();
   request->send(200, "text/plain", F("✅ Log cleared"));
 }
 
@@ -134,94 +132,12 @@ void handleLogin(AsyncWebServerRequest *request)
 // ============================================================
 void handleJson(AsyncWebServerRequest *request)
 {
-  JsonDocument json;
-  fillJson(json);
-  String output;
-  serializeJsonPretty(json, output);
-  request->send(200, "application/json", output);
+  sendJson(request, fillJson);
 }
 
 void ota_status(AsyncWebServerRequest *request)
 {
-  AsyncResponseStream *response = request->beginResponseStream("application/json");
-  JsonDocument doc;
-  doc[F("progress")] = currentOTAProgress;
-  doc[F("total")] = totalOTABytes;
-  serializeJson(doc, *response);
-  request->send(response);
-}
-
-// ============================================================
-// 🔹 OTA Update Handlers
-// ============================================================
-void handleUpdateFirmware(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
-{
-  if (!index)
-  {
-    currentOTAProgress = 0;
-    totalOTABytes = request->contentLength();
-    Serial.printf_P(PSTR("[OTA] Starting firmware update (%u bytes)...\n"), totalOTABytes);
-    if (!Update.begin(UPDATE_SIZE_UNKNOWN))
-    {
-      request->send(500, "text/plain", F("❌ Error initializing update."));
-      return;
-    }
-  }
-
-  currentOTAProgress = index + len;
-  if (!Update.hasError() && Update.write(data, len) != len)
-    Serial.printf_P(PSTR("[OTA] Incomplete write: %u bytes\n"), len);
-
-  if (final)
-  {
-    if (Update.end(true))
-    {
-      Serial.println(F("[OTA] Firmware updated successfully!"));
-      request->send(200, "text/plain", F("✅ Firmware updated successfully! Restarting in 2 seconds..."));
-      delay(1000);
-      ESP.restart();
-    }
-    else
-    {
-      Serial.printf_P(PSTR("[OTA] Error: %s\n"), Update.errorString());
-      request->send(500, "text/plain", String(F("❌ Update failed: ")) + Update.errorString());
-    }
-  }
-}
-
-void handleUpdateLittleFS(AsyncWebServerRequest *request, String filename, size_t index, uint8_t *data, size_t len, bool final)
-{
-  if (!index)
-  {
-    currentFSProgress = 0;
-    totalFSBytes = request->contentLength();
-    Serial.printf_P(PSTR("[OTA] Starting LittleFS update (%u bytes)...\n"), totalFSBytes);
-    if (!Update.begin(UPDATE_SIZE_UNKNOWN, U_SPIFFS))
-    {
-      request->send(500, "text/plain", F("❌ Error initializing LittleFS update."));
-      return;
-    }
-  }
-
-  currentFSProgress = index + len;
-  if (!Update.hasError() && Update.write(data, len) != len)
-    Serial.printf_P(PSTR("[OTA] Incomplete LittleFS write: %u bytes\n"), len);
-
-  if (final)
-  {
-    if (Update.end(true))
-    {
-      Serial.println(F("[OTA] LittleFS updated successfully!"));
-      request->send(200, "text/plain", F("✅ LittleFS updated successfully! Restarting in 2 seconds..."));
-      delay(3000);
-      ESP.restart();
-    }
-    else
-    {
-      Serial.printf_P(PSTR("[OTA] LittleFS Error: %s\n"), Update.errorString());
-      request->send(500, "text/plain", String(F("❌ LittleFS update failed: ")) + Update.errorString());
-    }
-  }
+  sendJson(request, fillOtaStatus);
 }
 
 // ============================================================
@@ -255,28 +171,20 @@ void setMode(AsyncWebServerRequest *req)
 void toggleFan(AsyncWebServerRequest *req)
 {
   g_settings.manual_on = !g_settings.manual_on;
-  String out = String(F("{\"ok\":true,\"manual_on\":")) + (g_settings.manual_on ? "true" : "false") + "}";
-  req->send(200, "application/json", out);
+  settingsTouch();
+  JsonArenaScope arena;
+  TextBuilder out(arena, 40);
+  out.printf("{\"ok\":true,\"manual_on\":%s}", g_settings.manual_on ? "true" : "false");
+  sendText(req, 200, "application/json", out);
 }
 // ============================================================
 // 🔹 Wi-Fi Info
 // ============================================================
-void wifi_info(AsyncWebServerRequest *request)
+// Scan results come from the background scan cache; the handler
+// never blocks on the radio.
+void fillWifiInfo(JsonDocument &doc)
 {
-  JsonDocument doc;
-
-  int n = WiFi.scanNetworks();
-  JsonArray networks = doc[F("available")].to<JsonArray>();
-
-  for (int i = 0; i < n; ++i)
-  {
-    JsonObject net = networks.add<JsonObject>();
-    net[F("ssid")] = WiFi.SSID(i);
-    net[F("rssi")] = WiFi.RSSI(i);
-    net[F("bssid")] = WiFi.BSSIDstr(i);
-    net[F("channel")] = WiFi.channel(i);
-    net[F("encryption")] = WiFi.encryptionType(i);
-  }
+  fillWifiScan(doc);
 
   JsonObject current = doc[F("current")].to<JsonObject>();
   current[F("connected_ssid")] = WiFi.SSID();
@@ -289,36 +197,177 @@ void wifi_info(AsyncWebServerRequest *request)
   current[F("subnet")] = WiFi.subnetMask().toString();
   current[F("status")] = WiFi.status();
 
-  String output;
-  serializeJsonPretty(doc, output);
-  request->send(200, "application/json", output);
+  fillWifiMetrics(doc[F("connect")].to<JsonObject>());
+}
+
+void wifi_info(AsyncWebServerRequest *request)
+{
+  // ?rescan=1 forces a new scan; otherwise only stale results are refreshed
+  bool force = false;
+  if (request->hasParam("rescan"))
+  {
+    const String &v = request->getParam("rescan")->value();
+    force = v == "1" || v.equalsIgnoreCase("true");
+  }
+  requestWifiScan(force);
+  sendJson(request, fillWifiInfo);
 }
 
 // ============================================================
 // 🔹 Files List
 // ============================================================
+// Bytes printJsonString() would write
+static size_t jsonStringLength(const char *s)
+{
+  size_t n = 2;
+  for (; *s; s++)
+  {
+    char c = *s;
+    n += (c == '"' || c == '\\') ? 2 : (uint8_t)c < 0x20 ? 6 : 1;
+  }
+  return n;
+}
+
+// Writes `s` as a quoted, escaped JSON string
+static void printJsonString(Print &out, const char *s)
+{
+  out.print('"');
+  for (; *s; s++)
+  {
+    char c = *s;
+    if (c == '"' || c == '\\')
+    {
+      out.print('\\');
+      out.print(c);
+    }
+    else if ((uint8_t)c < 0x20)
+      out.printf("\\u%04x", c);
+    else
+      out.print(c);
+  }
+  out.print('"');
+}
+
+// Sized by a first pass over the directory, then written once
+// into the request pool.
 void files_list(AsyncWebServerRequest *request)
 {
-  String json = "[";
+  size_t len = 2;
   File root = LittleFS.open("/");
-  File file = root.openNextFile();
-  while (file)
+  for (File file = root.openNextFile(); file; file = root.openNextFile())
+    len += jsonStringLength(file.name()) + 1;
+
+  JsonArenaScope arena;
+  TextBuilder out(arena, len);
+  out.write('[');
+  root.rewindDirectory();
+  bool first = true;
+  for (File file = root.openNextFile(); file; file = root.openNextFile())
   {
-    if (json.length() > 1)
-      json += ",";
-    json += "\"" + String(file.name()) + "\"";
-    file = root.openNextFile();
+    if (!first)
+      out.write(',');
+    printJsonString(out, file.name());
+    first = false;
   }
-  json += "]";
-  request->send(200, "application/json", json);
+  out.write(']');
+  sendText(request, 200, "application/json", out);
+}
+
+// ============================================================
+// 🔹 Files API (recursive, paginated)
+// ------------------------------------------------------------
+// GET /api/files?dir=/&recursive=1&cursor=0&limit=50
+// Walks the tree depth-first and streams one page of entries
+// (path, type, size, mtime) plus LittleFS totals. The cursor is
+// the index of the first entry to return, so no walk state is
+// kept on the device between pages.
+// ============================================================
+#define FILES_PAGE_MAX 200
+#define FILES_PENDING_DIRS 32
+
+void apiFiles(AsyncWebServerRequest *request)
+{
+  String dir = request->hasParam("dir") ? request->getParam("dir")->value() : String("/");
+  if (!dir.startsWith("/"))
+    dir = "/" + dir;
+  bool recursive = !request->hasParam("recursive") || request->getParam("recursive")->value() != "0";
+  uint32_t cursor = request->hasParam("cursor") ? request->getParam("cursor")->value().toInt() : 0;
+  uint32_t limit = request->hasParam("limit") ? request->getParam("limit")->value().toInt() : 50;
+  limit = constrain(limit, 1, FILES_PAGE_MAX);
+
+  File top = LittleFS.open(dir);
+  if (!top || !top.isDirectory())
+  {
+    request->send(404, "application/json", F("{\"error\":\"directory not found\"}"));
+    return;
+  }
+  top.close();
+
+  AsyncResponseStream *res = request->beginResponseStream("application/json");
+  res->printf("{\"fs\":{\"total\":%u,\"used\":%u},\"dir\":",
+              (unsigned)LittleFS.totalBytes(), (unsigned)LittleFS.usedBytes());
+  printJsonString(*res, dir.c_str());
+  res->print(F(",\"entries\":["));
+
+  std::vector<String> pending;
+  pending.push_back(dir);
+
+  uint32_t index = 0;
+  uint32_t emitted = 0;
+  bool more = false;
+  bool truncated = false;
+
+  while (!pending.empty() && !more)
+  {
+    String path = pending.back();
+    pending.pop_back();
+
+    File d = LittleFS.open(path);
+    if (!d || !d.isDirectory())
+      continue;
+
+    for (File f = d.openNextFile(); f; f = d.openNextFile())
+    {
+      bool isDir = f.isDirectory();
+      if (isDir && recursive)
+      {
+        if (pending.size() < FILES_PENDING_DIRS)
+          pending.push_back(f.path());
+        else
+          truncated = true;
+      }
+
+      if (index++ < cursor)
+        continue;
+      if (emitted == limit)
+      {
+        more = true;
+        break;
+      }
+
+      if (emitted++)
+        res->print(',');
+      res->print(F("{\"path\":"));
+      printJsonString(*res, f.path());
+      res->printf(",\"type\":\"%s\",\"size\":%u,\"mtime\":%ld}",
+                  isDir ? "dir" : "file", (unsigned)(isDir ? 0 : f.size()), (long)f.getLastWrite());
+    }
+  }
+
+  res->print(F("],\"next_cursor\":"));
+  if (more)
+    res->print(cursor + emitted);
+  else
+    res->print(F("null"));
+  res->printf(",\"count\":%u,\"truncated\":%s}", (unsigned)emitted, truncated ? "true" : "false");
+  request->send(res);
 }
 
 // ============================================================
 // 🔹 Memory Info
 // ============================================================
-void mem_info(AsyncWebServerRequest *request)
+void fillMemInfo(JsonDocument &doc)
 {
-  JsonDocument doc;
   esp_chip_info_t chip_info;
   esp_chip_info(&chip_info);
 
@@ -355,10 +404,13 @@ void mem_info(AsyncWebServerRequest *request)
   doc[F("chip_rev")] = revLabel;
   doc[F("sdk_version")] = String(esp_get_idf_version());
   doc[F("cpu_freq_mhz")] = ESP.getCpuFreqMHz();
+  fillJsonPoolStats(doc[F("json_pool")].to<JsonArray>());
+  fillHeapTrend(doc[F("heap_trend")].to<JsonObject>());
+}
 
-  String output;
-  serializeJsonPretty(doc, output);
-  request->send(200, "application/json", output);
+void mem_info(AsyncWebServerRequest *request)
+{
+  sendJson(request, fillMemInfo);
 }
 
 // ============================================================
@@ -366,12 +418,11 @@ void mem_info(AsyncWebServerRequest *request)
 // ============================================================
 void alarma(AsyncWebServerRequest *request)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   doc[F("alarmTriggered")] = g_settings.alarmTriggered;
   doc[F("active")] = (millis() - g_settings.reactivateAlarmCounter) < g_settings.deactivateAlarmTime;
-  String output;
-  serializeJson(doc, output);
-  request->send(200, "application/json", output);
+  sendJson(request, doc);
 }
 
 // ============================================================
@@ -381,10 +432,8 @@ void web_restart(AsyncWebServerRequest *request)
 {
   Serial.println(F("ℹ️ Saving settings before restart..."));
   settingsSaveToFS();
-  delay(200);
   request->send(200, "text/plain", F("ESP32 restarting..."));
-  delay(3000);
-  ESP.restart();
+  scheduleRestart(3000);
 }
 
 // ============================================================
@@ -392,68 +441,206 @@ void web_restart(AsyncWebServerRequest *request)
 // ============================================================
 void handleFSStatus(AsyncWebServerRequest *request)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   float progress = 0;
   if (totalFSBytes > 0)
     progress = (float)currentFSProgress / totalFSBytes * 100.0;
   doc[F("progress")] = progress;
-  String json;
-  serializeJson(doc, json);
-  request->send(200, "application/json", json);
+  sendJson(request, doc);
 }
 
 // ============================================================
 // 🔹 File Read / Delete / Format
 // ============================================================
+#define FILE_PATH_MAX 64   // LittleFS path incl. leading '/'
+
+// MIME type from the file extension (binary when unknown)
+const char *mimeTypeFor(const char *path)
+{
+  size_t len = strlen(path);
+  static const struct
+  {
+    const char *ext;
+    const char *mime;
+  } types[] = {
+      {".html", "text/html"},
+      {".htm", "text/html"},
+      {".css", "text/css"},
+      {".js", "application/javascript"},
+      {".json", "application/json"},
+      {".txt", "text/plain"},
+      {".log", "text/plain"},
+      {".csv", "text/csv"},
+      {".xml", "text/xml"},
+      {".png", "image/png"},
+      {".jpg", "image/jpeg"},
+      {".ico", "image/x-icon"},
+      {".svg", "image/svg+xml"},
+      {".mp3", "audio/mpeg"},
+      {".wav", "audio/wav"},
+      {".gz", "application/gzip"},
+      {".bin", "application/octet-stream"},
+  };
+
+  for (auto &t : types)
+  {
+    size_t n = strlen(t.ext);
+    if (len >= n && !strcmp(path + len - n, t.ext))
+      return t.mime;
+  }
+  return "application/octet-stream";
+}
+
+// Parse a single "bytes=a-b" / "bytes=a-" / "bytes=-n" range.
+// Returns false if the header cannot be satisfied for `size`.
+static bool parseRange(const char *header, size_t size, size_t &start, size_t &end)
+{
+  if (strncmp(header, "bytes=", 6) || strchr(header, ',') || size == 0)
+    return false;
+
+  const char *p = header + 6;
+  const char *dash = strchr(p, '-');
+  if (!dash)
+    return false;
+
+  while (*p == ' ')
+    p++;
+  const char *q = dash + 1;
+  while (*q == ' ')
+    q++;
+  bool hasLast = isdigit((unsigned char)*q);
+
+  if (p == dash)
+  {
+    // Suffix range: last N bytes
+    long n = hasLast ? strtol(q, nullptr, 10) : 0;
+    if (n <= 0)
+      return false;
+    start = (size_t)n >= size ? 0 : size - n;
+    end = size - 1;
+    return true;
+  }
+
+  start = strtoul(p, nullptr, 10);
+  end = hasLast ? min((size_t)strtoul(q, nullptr, 10), size - 1) : size - 1;
+  return start < size && start <= end;
+}
+
+// Message with the file name, built in the request pool
+static void sendFileMessage(AsyncWebServerRequest *request, int code, const char *what, const char *path)
+{
+  JsonArenaScope arena;
+  TextBuilder out(arena, FILE_PATH_MAX + 48);
+  out.printf("%s: %s", what, path);
+  sendText(request, code, "text/plain", out);
+}
+
+// Absolute path from the `name` parameter; false if it does not fit
+static bool fileParam(AsyncWebServerRequest *request, bool post, char *path, size_t n)
+{
+  const String &name = request->getParam("name", post)->value();
+  return snprintf(path, n, "%s%s", name.startsWith("/") ? "" : "/", name.c_str()) < (int)n;
+}
+
+// Streams the file from LittleFS in response-sized chunks, so even large
+// logs never sit in RAM. Honors a single Range (206) for resumed downloads.
 void readFile(AsyncWebServerRequest *request)
 {
+  char filename[FILE_PATH_MAX];
   if (!request->hasParam("name"))
   {
-    request->send(400, "text/plain", F("❌ Missing parameter 'name'"));
+    sendConst(request, 400, "text/plain", "❌ Missing parameter 'name'");
+    return;
+  }
+  if (!fileParam(request, false, filename, sizeof(filename)))
+  {
+    sendConst(request, 400, "text/plain", "❌ Path too long");
     return;
   }
-  String filename = request->getParam("name")->value();
-  if (!filename.startsWith("/"))
-    filename = "/" + filename;
   if (!LittleFS.exists(filename))
   {
-    request->send(404, "text/plain", String(F("❌ File not found: ")) + filename);
+    sendFileMessage(request, 404, "❌ File not found", filename);
     return;
   }
   File f = LittleFS.open(filename, "r");
-  if (!f)
+  if (!f || f.isDirectory())
   {
-    request->send(500, "text/plain", String(F("❌ Error opening file: ")) + filename);
+    sendFileMessage(request, 500, "❌ Error opening file", filename);
     return;
   }
-  String content;
-  while (f.available())
-    content += char(f.read());
-  f.close();
-  request->send(200, "text/plain", content);
+
+  size_t size = f.size();
+  size_t start = 0;
+  size_t end = size ? size - 1 : 0;
+  bool partial = false;
+
+  if (request->hasHeader("Range"))
+  {
+    if (!parseRange(request->getHeader("Range")->value().c_str(), size, start, end))
+    {
+      char range[24];
+      snprintf(range, sizeof(range), "bytes */%u", (unsigned)size);
+      AsyncWebServerResponse *res = request->beginResponse(416);
+      res->addHeader("Content-Range", range);
+      request->send(res);
+      return;
+    }
+    partial = true;
+  }
+
+  size_t length = size ? end - start + 1 : 0;
+  AsyncWebServerResponse *res = request->beginResponse(
+      mimeTypeFor(filename), length,
+      [f, start, length](uint8_t *buf, size_t maxLen, size_t index) mutable -> size_t
+      {
+        if (index >= length)
+          return 0;
+        if (f.position() != start + index)
+          f.seek(start + index);
+        return f.read(buf, min(maxLen, length - index));
+      });
+
+  res->addHeader("Accept-Ranges", "bytes");
+  if (partial)
+  {
+    char range[64];
+    snprintf(range, sizeof(range), "bytes %u-%u/%u", (unsigned)start, (unsigned)end, (unsigned)size);
+    res->setCode(206);
+    res->addHeader("Content-Range", range);
+  }
+  if (request->hasParam("download"))
+  {
+    char disposition[FILE_PATH_MAX + 32];
+    snprintf(disposition, sizeof(disposition), "attachment; filename=\"%s\"", strrchr(filename, '/') + 1);
+    res->addHeader("Content-Disposition", disposition);
+  }
+  request->send(res);
 }
 
 void deleteFile(AsyncWebServerRequest *request)
 {
-  String filename;
-  if (request->hasParam("name"))
-    filename = request->getParam("name")->value();
-  else if (request->hasParam("name", true))
-    filename = request->getParam("name", true)->value();
-  else
+  char filename[FILE_PATH_MAX];
+  bool post = !request->hasParam("name");
+  if (post && !request->hasParam("name", true))
   {
-    request->send(400, "text/plain", F("❌ Missing parameter 'name'"));
+    sendConst(request, 400, "text/plain", "❌ Missing parameter 'name'");
+    return;
+  }
+  if (!fileParam(request, post, filename, sizeof(filename)))
+  {
+    sendConst(request, 400, "text/plain", "❌ Path too long");
     return;
   }
   if (!LittleFS.exists(filename))
   {
-    request->send(404, "text/plain", F("❌ File not found"));
+    sendConst(request, 404, "text/plain", "❌ File not found");
     return;
   }
   if (LittleFS.remove(filename))
-    request->send(200, "text/plain", String(F("✅ File deleted: ")) + filename);
+    sendFileMessage(request, 200, "✅ File deleted", filename);
   else
-    request->send(500, "text/plain", F("❌ File deletion failed"));
+    sendConst(request, 500, "text/plain", "❌ File deletion failed");
 }
 
 void formatFS(AsyncWebServerRequest *request)
@@ -513,11 +700,10 @@ void favicon(AsyncWebServerRequest *req)
 // ============================================================
 void get_settings(AsyncWebServerRequest *request)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   doc[F("demoSetting")] = F("Example setting for testing JSON response");
-  String output;
-  serializeJson(doc, output);
-  request->send(200, "application/json", output);
+  sendJson(request, doc);
 }
 
 // ============================================================
@@ -581,7 +767,89 @@ void settings(AsyncWebServerRequest *req)
 // ============================================================
 void apiSettingsDefault(AsyncWebServerRequest *req)
 {
-  req->send(200, "application/json", settingsDefaultsJson());
+  sendJson(req, [](JsonDocument &doc)
+           { fillJsonFrom(SystemSettings(), doc); });
+}
+
+// ============================================================
+// 🔹 API Settings / Sensors
+// ============================================================
+void fillSettings(JsonDocument &doc)
+{
+  fillJsonFrom(g_settings, doc);
+}
+
+void apiSettings(AsyncWebServerRequest *req)
+{
+  sendJson(req, fillSettings);
+}
+
+void fillSensorValues(JsonObject o)
+{
+  o["systemC"] = sensorData.systemC;
+  o["engineC"] = sensorData.engineC;
+  o["ts"] = sensorData.ts;
+  o["manual_percent"] = g_settings.manual_percent;
+  o["targetPercent"] = sensorData.targetPercent;
+  o["target_pwm"] = sensorData.target_pwm;
+  fillTach(o["tach"].to<JsonObject>());
+  fillFusion(o["fusion"].to<JsonObject>());
+}
+
+void fillSensors(JsonDocument &doc)
+{
+  fillSensorValues(doc.to<JsonObject>());
+}
+
+void apiSensors(AsyncWebServerRequest *req)
+{
+  LOGI("📡 GET /api/sensors called");
+  sendJson(req, fillSensors);
+}
+
+// ============================================================
+// 🔹 Fan zones: settings + live state of every zone
+// ============================================================
+void apiZones(AsyncWebServerRequest *req)
+{
+  sendJson(req, fillZones);
+}
+
+// ============================================================
+// 🔹 Task CPU / Stack (?history=1 adds the per-sample ring)
+// ============================================================
+void apiTasks(AsyncWebServerRequest *req)
+{
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
+  fillTaskStats(doc, req->hasParam("history"));
+  sendJson(req, doc);
+}
+
+// ============================================================
+// 🔹 Per-route HTTP stats (?reset=1 clears after reading)
+// ============================================================
+void apiRouteStats(AsyncWebServerRequest *req)
+{
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
+  fillRouteStats(doc);
+  if (req->hasParam("reset"))
+    routeStatsReset();
+  sendJson(req, doc);
+}
+
+// ============================================================
+// 🔹 Scope Profiler (?reset=1 clears after reading)
+// ============================================================
+void apiProfile(AsyncWebServerRequest *req)
+{
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
+  fillProfile(doc);
+  if (req->hasParam("reset"))
+    profileReset();
+  sendJson(req, doc);
 }
 
 // ============================================================
@@ -589,7 +857,8 @@ void apiSettingsDefault(AsyncWebServerRequest *req)
 // ============================================================
 void sendSmsView(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
 {
-  JsonDocument doc;
+  JsonArenaScope arena;
+  JsonDocument doc(arena.allocator());
   if (deserializeJson(doc, data, len))
   {
     request->send(400, "application/json", F("{\"error\":\"Invalid message\"}"));
@@ -0,0 +1,129 @@
+// temp_filter_sim.cpp
+//
+// Simulare pe host pentru include/temp_filter.h: un profil de
+// temperatura a motorului (repaus, incalzire, platou, racire),
+// citit de un DS18B20 (o data pe secunda, valoarea veche de 750 ms,
+// rezolutie 0.0625 C) si de un NTC (la 100 ms, zgomot 0.5 C).
+// Compilare, rulare si verificari: host_check.h.
+//
+// Verificari:
+//   1. in timpul incalzirii (0.5 C/s) estimarea DS-only nu mai
+//      ramane in urma ca valoarea bruta (compensarea intarzierii)
+//   2. fuziunea DS + NTC are eroare RMS mai mica decat DS brut
+//   3. viteza de crestere estimata e la +/- 20% de cea reala
+//   4. predictia la 5 s e mai aproape de temperatura de peste 5 s
+//      decat estimarea curenta
+//   5. fara citiri (senzor deconectat) estimarea devine NaN dupa
+//      staleMs si revine la prima citire valida
+
+#include <cstdio>
+#include <cmath>
+#include "temp_filter.h"
+#include "host_check.h"
+
+// True engine temperature at t (ms)
+static float truth(uint32_t ms)
+{
+  float s = ms / 1000.0f;
+  if (s < 30)
+    return 40;
+  if (s < 90)
+    return 40 + (s - 30) * 0.5f;   // 0.5 °C/s
+  if (s < 150)
+    return 70;
+  return 70 - (s - 150) * 0.2f;
+}
+
+static uint32_t seed = 11;
+static float gauss()
+{
+  float u = 0;
+  for (int k = 0; k < 12; k++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    u += (seed >> 8) / (float)(1u << 24);
+  }
+  return u - 6;
+}
+
+static const float VAR_DS = 0.01f;
+static const float VAR_NTC = 0.25f;
+static const uint32_t DS_LAG_MS = 750;
+
+struct Stats
+{
+  double sum = 0;
+  int n = 0;
+  void add(float e)
+  {
+    sum += (double)e * e;
+    n++;
+  }
+  float rms() const { return n ? sqrt(sum / n) : NAN; }
+};
+
+int main(int argc, char **argv)
+{
+  hostCheckBegin(argc, argv);
+
+  TempKalman dsOnly, fused;
+  float rawDs = NAN;
+  Stats eRaw, eDs, eFused, ePredNow, ePredAhead;
+  float rateSum = 0;
+  int rateN = 0;
+
+  for (uint32_t ms = 0; ms < 200000; ms += 10)
+  {
+    // DS18B20: conversion starts every second, value read 750 ms later
+    if (ms % 1000 == DS_LAG_MS)
+    {
+      float z = roundf((truth(ms - DS_LAG_MS) + 0.05f * gauss()) / 0.0625f) * 0.0625f;
+      rawDs = z;
+      dsOnly.update(z, VAR_DS, ms, DS_LAG_MS / 1000.0f);
+      fused.update(z, VAR_DS, ms, DS_LAG_MS / 1000.0f);
+    }
+    if (ms % 100 == 0)
+      fused.update(truth(ms) + 0.5f * gauss(), VAR_NTC, ms);
+
+    if (ms < 5000 || ms % 100)
+      continue;
+    float tr = truth(ms);
+    bool ramp = ms > 40000 && ms < 90000;
+    if (ramp)
+    {
+      eRaw.add(rawDs - tr);
+      eDs.add(dsOnly.at(ms) - tr);
+      rateSum += fused.rate(ms);
+      rateN++;
+    }
+    eFused.add(fused.at(ms) - tr);
+    if (ms + 5000 < 200000 && ms > 40000 && ms < 85000)
+    {
+      ePredNow.add(fused.at(ms) - truth(ms + 5000));
+      ePredAhead.add(fused.predicted(ms, 5) - truth(ms + 5000));
+    }
+    if (trace && ms % 2000 == 0)
+      printf("  t=%6.1f s true=%6.2f ds=%6.2f est=%6.2f rate=%+5.2f pred5=%6.2f\n", ms / 1000.0f, tr, rawDs,
+             fused.at(ms), fused.rate(ms), fused.predicted(ms, 5));
+  }
+
+  printf("     ramp: raw DS rms %.3f C, DS-only filter %.3f C\n", eRaw.rms(), eDs.rms());
+  check(eDs.rms() < eRaw.rms() * 0.5f, "lag compensation halves the ramp error of the raw DS18B20");
+  printf("     whole run: fused rms %.3f C\n", eFused.rms());
+  check(eFused.rms() < 0.2f, "DS + NTC fusion tracks within 0.2 C rms");
+  float rate = rateSum / rateN;
+  printf("     ramp rate: %.3f C/s (true 0.5)\n", rate);
+  check(fabsf(rate - 0.5f) < 0.1f, "rate of rise within 20%");
+  printf("     T(+5 s): now %.3f C rms, predicted %.3f C rms\n", ePredNow.rms(), ePredAhead.rms());
+  check(ePredAhead.rms() < ePredNow.rms() * 0.5f, "5 s prediction beats the current estimate");
+
+  TempKalman drop;
+  drop.update(50, VAR_DS, 0);
+  drop.update(NAN, VAR_DS, 1000);
+  bool coasting = !isnan(drop.at(4000));
+  bool stale = isnan(drop.at(6000)) && isnan(drop.predicted(6000, 5));
+  drop.update(52, VAR_DS, 7000);
+  check(coasting && stale && fabsf(drop.at(7000) - 52) < 0.5f, "dropout: NaN ignored, stale after staleMs, recovers");
+
+  return hostCheckDone();
+}